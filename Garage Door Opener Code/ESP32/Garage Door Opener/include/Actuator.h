@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_timer.h"
+#include "Telemetry.h"
+
+// Bits reported by Actuator::takeEvents()
+constexpr uint8_t ACTUATION_ENERGIZED = 0x01;
+constexpr uint8_t ACTUATION_RELEASED  = 0x02;
+
+/**
+ * Timed relay actuation stage.
+ * trigger() only arms an esp_timer, so it is cheap enough to call from the BLE callback task.
+ * The relay is energized and released from the esp_timer task, independently of loop()
+ * and of whatever the display is doing. loop() collects the resulting events with takeEvents().
+ */
+class Actuator {
+public:
+    Actuator(uint8_t relayPin, uint32_t pulseMillis);
+
+    /**
+     * Configures the relay pin (released) and creates the pulse timers. Call once from setup().
+     * @param wakeTask task notified whenever new events are available (usually the loop task), may be nullptr
+     */
+    void begin(TaskHandle_t wakeTask);
+
+    /**
+     * Requests one relay pulse.
+     * @return true if the pulse was scheduled, false if a pulse is already in progress
+     */
+    bool trigger();
+
+    // Returns the ACTUATION_* bits raised since the previous call and clears them.
+    uint8_t takeEvents();
+
+    bool isBusy() const { return busy.load(); }
+
+    // latencyTimestamp() of the most recent energize
+    uint32_t lastEnergizedAt() const { return energizedAt.load(); }
+
+    void setPulseMillis(uint32_t millis) { pulseMillis = millis; }
+    uint32_t getPulseMillis() const { return pulseMillis; }
+
+private:
+    static void onEnergizeTimer(void *arg);
+    static void onReleaseTimer(void *arg);
+
+    const uint8_t relayPin;
+    volatile uint32_t pulseMillis;
+    TaskHandle_t wakeTask = nullptr;
+    esp_timer_handle_t energizeTimer = nullptr;
+    esp_timer_handle_t releaseTimer = nullptr;
+    std::atomic<bool> busy{false};
+    std::atomic<uint8_t> events{0};
+    std::atomic<uint32_t> energizedAt{0};
+};
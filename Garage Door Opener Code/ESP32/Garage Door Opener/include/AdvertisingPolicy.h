@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Who advertising answers. Loop task only (setup() counts).
+//
+// With ADVERTISING_FILTER_ENABLED (see Config.h), outside the pairing window the bonded
+// addresses sit in the controller's whitelist and advertising only takes scan and connect
+// requests from them, so a stranger's connect is dropped by the controller and never reaches
+// the BLE task. While allowNewPairing is set advertising is open so a new phone can start
+// pairing. The onConnect allowlist check stays as the fallback, e.g. when there are more
+// bonds than whitelist entries, and is the only filter in builds without the flag.
+
+// Fills the controller whitelist from bondAllowlist; call once the allowlist is loaded
+void loadWhitelist();
+
+// (Re)starts advertising with the filter that matches allowNewPairing, first copying any
+// bonds added since the last call into the whitelist
+void startAdvertising();
+void stopAdvertising();
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "Actuator.h"
+#include "AuditLog.h"
+#include "BleEvent.h"
+#include "BondAllowlist.h"
+#include "BootTimeline.h"
+#include "ButtonMonitor.h"
+#include "CommandQueue.h"
+#include "Config.h"
+#include "ConnParamManager.h"
+#include "ConnectionTable.h"
+#include "DeviceRegistry.h"
+#include "DisplayEngine.h"
+#include "DoorSensor.h"
+#include "EventQueue.h"
+#include "Log.h"
+#include "Max7219Display.h"
+#include "Scheduler.h"
+#include "Telemetry.h"
+
+// Firmware-wide state shared by setup()/loop(), the BLE callbacks and the event handlers.
+// Defined in AppState.cpp.
+
+extern BootTimeline bootTimeline;
+
+// MAX7219 driver; drawing goes to a framebuffer and flush() only sends the digits that changed
+extern Max7219Display display;
+
+// Layers on top of display: passkey over status text over the idle animation
+extern DisplayEngine displayEngine;
+
+// In-RAM copy of the stack's bond table, used for every connect/security check
+extern BondAllowlist bondAllowlist;
+
+// Relay pulse runs on its own timers so BLE writes are acknowledged immediately
+extern Actuator actuator;
+
+extern uint32_t triggerWrittenAt; // latencyTimestamp() of the write that started the running pulse
+
+// Latency histograms and counters, exported on the stats characteristic and over serial ('s')
+extern Telemetry telemetry;
+
+// Current links and their auth state, maintained by the BLE callbacks
+extern ConnectionTable connections;
+
+// Commands from every connection, served round-robin by loop()
+extern CommandQueue commandQueue;
+
+// Door events in the audit partition (loop task)
+extern AuditLog auditLog;
+
+// Name, last seen and trigger count of every bonded device, one NVS blob, dumped over serial ('d') (loop task)
+extern DeviceRegistry deviceRegistry;
+
+// Fast/idle connection parameter profiles of the authenticated links (loop task)
+extern ConnParamManager connParams;
+
+// Written by loop(); atomics because the BLE task reads them too
+extern std::atomic<uint32_t> currentDisplayedPasskey;
+extern std::atomic<bool> pairingModeActive;  // True if the device is currently advertising for new pairings
+extern std::atomic<bool> allowNewPairing;    // Only true during explicit pairing mode activated by button, read by the BLE task
+
+// All timeouts live in the scheduler; handlers run on the loop task
+extern Scheduler scheduler;
+
+// Pairing / factory reset button, edge interrupt plus debounce and hold timing
+extern ButtonMonitor button;
+
+// Door position switches, same edge interrupt plus debounce scheme (loop task)
+extern DoorSensor doorSensor;
+// DoorState | transitions << 8, written by loop() and read by the BLE task to answer reads
+extern std::atomic<uint16_t> doorStatus;
+
+// Task running loop(), woken early by the button interrupt and by posted BLE events
+extern TaskHandle_t loopTaskHandle;
+
+extern SpscRing<BleEvent, BLE_EVENT_QUEUE_SIZE> bleEvents;
+// Every link may post a write's worth of commands before loop() drains the ring, and the
+// connect and auth events of that moment need room next to them
+static_assert(BLE_EVENT_QUEUE_SIZE >= CommandQueue::LANE_DEPTH * MAX_CONNECTIONS + 2 * MAX_CONNECTIONS,
+              "BLE_EVENT_QUEUE_SIZE drops commands the per-connection lanes would still take");
+extern uint32_t bleEventCounts[static_cast<uint8_t>(BleEventType::Count)]; // Handled events per type
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "esp_partition.h"
+#include "Config.h"
+
+// What happened at the door; stored as a byte, append only
+enum class AuditEvent : uint8_t {
+    Boot,            // Uptimes of the records after it count from here
+    Trigger,         // Relay pulse requested (started or joined), by address
+    Connect,         // Link up, by address
+    ConnectRejected, // Unknown device turned away, by address
+    PairingOpened,   // Pairing window opened with the button
+    Paired,          // New bond made, by address
+    PairingRejected, // Pairing attempt outside the window, by address when known
+    FactoryReset,    // Bonds wiped; the audit log itself survives
+    Revoked,         // One bond removed on request, by address
+    Evicted,         // Least recently seen bond removed to make room for pairing, by address
+    DoorClosed,      // Door position switches, when fitted
+    DoorOpened,
+    DoorFault,       // Travel time ran out or both limits reported
+    Count
+};
+
+// One event as stored in flash and streamed over BLE, little endian
+struct __attribute__((packed)) AuditRecord {
+    uint32_t sequence;      // Consecutive across reboots
+    uint32_t uptimeSeconds; // Since the preceding Boot record
+    uint8_t event;          // AuditEvent
+    uint8_t address[6];     // Peer, zero when the event has none
+    uint8_t check;          // checksum(), tells torn writes and erased flash from records
+};
+static_assert(sizeof(AuditRecord) == 16, "Audit records must stay 16 bytes on flash and on the air");
+
+/**
+ * Append-only door event log in the "audit" data partition.
+ *
+ * The partition is a ring of 16 byte records filled sector by sector. Records collect in a
+ * RAM batch and go to flash in one write per AUDIT_BATCH_RECORDS events (or at the latest
+ * AUDIT_FLUSH_MILLIS after the first, see TIMER_AUDIT_FLUSH). A sector is erased only when the
+ * ring comes round to it again, dropping its 256 oldest records, so every sector sees the same
+ * number of erases. The 512 KB partition keeps the last 32512 to 32768 events.
+ *
+ * Nothing is stored besides the records: begin() finds the newest one from the sequence numbers
+ * at the start of each sector. A write cut short by a power loss leaves records that fail their
+ * checksum, and the ring carries on after them.
+ *
+ * Loop task only.
+ */
+class AuditLog {
+public:
+    /**
+     * Finds the partition and the end of the log.
+     * @return false without an audit partition; records are then dropped once the batch is full
+     */
+    bool begin();
+
+    // Queues a record; address may be nullptr. Flushes when the batch is full.
+    void append(AuditEvent event, const uint8_t *address, unsigned long now);
+
+    // Writes the queued records to flash
+    void flush();
+
+    bool hasUnsaved() const { return batchCount > 0; }
+
+    /**
+     * Copies stored records in sequence order, starting at from or at the oldest one kept.
+     * @return records copied, 0 once past the newest
+     */
+    size_t read(uint32_t from, AuditRecord *out, size_t max) const;
+
+    // Stored records are [oldestSequence(), nextSequence())
+    uint32_t oldestSequence() const { return oldest; }
+    uint32_t nextSequence() const { return next; }
+    uint32_t storedCount() const { return next - oldest; }
+
+    uint32_t flashWrites() const { return writes; }
+    uint32_t sectorErases() const { return erases; }
+    uint32_t droppedCount() const { return dropped; }
+
+    static uint8_t checksum(const AuditRecord &record);
+    static bool isValid(const AuditRecord &record) { return record.check == checksum(record); }
+
+private:
+    static constexpr uint32_t RECORDS_PER_SECTOR = SPI_FLASH_SEC_SIZE / sizeof(AuditRecord);
+
+    bool readSlot(uint32_t slot, AuditRecord &record) const;
+    void writeRun(const AuditRecord *records, uint32_t count);
+
+    const esp_partition_t *partition = nullptr;
+    uint32_t slots = 0;  // Record slots in the partition
+    uint32_t head = 0;   // Slot the next record goes to
+    uint32_t oldest = 0; // Sequence of the oldest stored record
+    uint32_t next = 0;   // Sequence the next record gets
+
+    AuditRecord batch[AUDIT_BATCH_RECORDS] = {};
+    uint8_t batchCount = 0;
+
+    uint32_t writes = 0;
+    uint32_t erases = 0;
+    uint32_t dropped = 0;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "esp_gap_ble_api.h" // esp_bd_addr_t and esp_ble_addr_type_t, plain types shared by both backends
+#include "BleEvent.h"
+
+/**
+ * The BLE host stack behind the firmware, picked at build time: the Arduino Bluedroid wrapper
+ * by default, NimBLE-Arduino with -D BLE_BACKEND_NIMBLE (env:upesy_wroom_nimble). Exactly one
+ * of BleBackendBluedroid.cpp and BleBackendNimble.cpp compiles to anything.
+ *
+ * The backend owns the stack objects and the GATT table and applies the same security policy
+ * on both stacks: LE Secure Connections, MITM protection and bonding, display-only IO so the
+ * passkey appears on the LED display. Its callbacks, on the stack's task, call the onBle*
+ * functions in BleCallbacks.h; addresses are identity addresses in esp_bd_addr_t byte order.
+ *
+ * Everything below is for the loop task (setup() counts) unless noted.
+ */
+
+enum class BleBackendKind : uint8_t {
+    Bluedroid,
+    NimBLE,
+};
+
+// Characteristics of the garage service
+enum class BleCharacteristic : uint8_t {
+    Control, // Commands in, replies and door status out; read returns the door status
+    Stats,   // Telemetry blob, refreshed by loop() while a link is up
+    Audit,   // Audit log download, notify only
+    Devices, // Device registry, read over an encrypted MITM link only
+    Count
+};
+
+namespace ble {
+
+#ifdef BLE_BACKEND_NIMBLE
+constexpr BleBackendKind BACKEND = BleBackendKind::NimBLE;
+#else
+constexpr BleBackendKind BACKEND = BleBackendKind::Bluedroid;
+#endif
+
+// Brings up the controller and host stack; BOOT_BLE_READY is stamped right after it
+void init(const char *name, uint16_t localMtu);
+
+// Security policy, GATT service and advertising data (the fast profile as preferred interval);
+// does not start advertising
+void startServer();
+
+void setValue(BleCharacteristic characteristic, const uint8_t *data, size_t length);
+
+/**
+ * Notifies one connection only, unlike the wrappers' notify() that sends to every peer.
+ * Sends whatever the link's CCCD says; callers check ConnectionTable::isSubscribed() first.
+ * @return false if the stack is out of buffers; the caller may retry later
+ */
+bool notify(BleCharacteristic characteristic, uint16_t connId, const uint8_t *data, size_t length);
+
+uint16_t peerMtu(uint16_t connId);
+
+// Any task
+void disconnect(uint16_t connId);
+
+// Starts MITM encryption on a new link (BLE task). @return 0 or the stack's error code
+uint32_t requestEncryption(uint16_t connId, const esp_bd_addr_t address);
+
+// Asks the central for new connection parameters; the outcome arrives as onBleConnParamsUpdated()
+void updateConnParams(uint16_t connId, const esp_bd_addr_t address, uint16_t minInterval, uint16_t maxInterval,
+                      uint16_t latency, uint16_t timeout);
+
+/**
+ * Copies the stack's bond table. May allocate a temporary list, so keep it off the hot path.
+ * @return bonds copied, at most capacity
+ */
+uint8_t listBonds(esp_bd_addr_t *addresses, esp_ble_addr_type_t *types, uint8_t capacity);
+void removeBond(const esp_bd_addr_t address);
+void clearBonds(); // Every bond and key the stack keeps in NVS
+
+// Controller whitelist; changes are refused while advertising filters on it
+void clearWhitelist();
+uint8_t whitelistCapacity();
+bool addToWhitelist(const esp_bd_addr_t address, esp_ble_addr_type_t type);
+
+// @param filtered scan and connect requests only from whitelisted devices
+void startAdvertising(bool filtered);
+void stopAdvertising();
+
+} // namespace ble
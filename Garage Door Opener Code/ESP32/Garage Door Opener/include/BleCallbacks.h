@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "BleBackend.h"
+
+// Called by the BLE backend on the stack's task. They only take the decisions the stack needs
+// right away (reject, disconnect, allow) and post everything else to loop() as BleEvents.
+
+void onBleConnect(uint16_t connId, const esp_bd_addr_t address);
+void onBleDisconnect(uint16_t connId, const esp_bd_addr_t address);
+
+// The stack wants a passkey shown for the link being paired
+void onBlePasskeyNotify(uint32_t passkey);
+
+// A peer asks to pair. @return false to refuse (Bluedroid only, NimBLE pairs and asks for the passkey)
+bool onBleSecurityRequest();
+
+// @param failReason stack specific, only meaningful when success is false
+void onBleAuthenticationComplete(const esp_bd_addr_t address, esp_ble_addr_type_t type, bool success,
+                                 uint32_t failReason);
+
+// A write to the control characteristic, parsed straight from the stack's buffer
+void onBleWrite(uint16_t connId, const esp_bd_addr_t address, const uint8_t *data, size_t length);
+
+// A peer wrote the CCCD of a notifying characteristic; only links that enabled it get notified
+void onBleSubscribe(uint16_t connId, BleCharacteristic characteristic, bool notifications);
+
+// A read is about to be answered; refreshes the value with ble::setValue()
+void onBleRead(BleCharacteristic characteristic);
+
+// The connection parameters of a link changed, whichever side asked for it
+void onBleConnParamsUpdated(const esp_bd_addr_t address, bool success, uint32_t status, const BleConnParams &params);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_gap_ble_api.h"
+#include "CommandProtocol.h"
+
+// What happened in a BLE callback, as handed from the BLE task to loop()
+enum class BleEventType : uint8_t {
+    Connected,        // value: esp_ble_set_encryption() result
+    ConnectRejected,  // Unknown device outside the pairing window, already disconnected
+    Disconnected,
+    PairingRejected,  // Passkey display refused outside the pairing window, already disconnected
+    Passkey,          // value: passkey to show
+    SecurityRequest,  // BLE_EVENT_SUCCESS if the request was allowed
+    AuthComplete,     // BLE_EVENT_SUCCESS on success (plus BLE_EVENT_NEW_BOND, BLE_EVENT_RELOAD_BONDS), otherwise value: failure reason
+    Command,          // command: one parsed command from a write
+    ConnParamsUpdated, // BLE_EVENT_SUCCESS if the update went through; connParams: what the link runs on now
+    Count
+};
+
+// BleEvent::flags
+constexpr uint8_t BLE_EVENT_SUCCESS   = 0x01;
+constexpr uint8_t BLE_EVENT_TEXT      = 0x02; // Command arrived as a legacy text write
+constexpr uint8_t BLE_EVENT_MALFORMED = 0x04; // Command frame could not be parsed or was too large
+constexpr uint8_t BLE_EVENT_NEW_BOND  = 0x08; // Authentication added an address to the allowlist
+constexpr uint8_t BLE_EVENT_RELOAD_BONDS = 0x10; // The allowlist was full, loop() reloads it from the stack
+
+// Connection parameters of a ConnParamsUpdated event, in controller units
+struct BleConnParams {
+    uint16_t interval; // 1.25 ms units
+    uint16_t latency;
+    uint16_t timeout;  // 10 ms units
+};
+
+struct BleEvent {
+    BleEventType type;
+    uint8_t flags;
+    uint16_t connId;
+    uint32_t timestamp; // latencyTimestamp() when the callback fired
+    uint32_t value;
+    esp_bd_addr_t address;
+    union {
+        CommandRecord command;
+        BleConnParams connParams;
+    };
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_gap_ble_api.h"
+
+// Size the cache to the stack's bond table so it can never overflow
+#if defined(BLE_BACKEND_NIMBLE) && defined(CONFIG_BT_NIMBLE_MAX_BONDS)
+constexpr uint8_t MAX_BONDED_DEVICES = CONFIG_BT_NIMBLE_MAX_BONDS;
+#elif defined(CONFIG_BT_SMP_MAX_BONDS)
+constexpr uint8_t MAX_BONDED_DEVICES = CONFIG_BT_SMP_MAX_BONDS;
+#else
+constexpr uint8_t MAX_BONDED_DEVICES = 15;
+#endif
+
+/**
+ * Statically allocated mirror of the bonded device addresses kept by the BLE stack.
+ * Loaded once from the stack in setup() and kept in sync by the pairing/reset code,
+ * so connection and security checks are an allocation-free lookup instead of a
+ * ble::listBonds() call per event.
+ *
+ * Writers on different tasks (add() on the BLE task after pairing, remove() on the loop task
+ * for revocation and eviction, load() and clear()) and contains() take a spinlock, so a
+ * lookup never sees a table half way through a change: load() fills a local copy and swaps
+ * it in under the lock, remove() moves the last entry into the gap under it. addressAt() is
+ * for the loop task, the only one that moves or drops entries; add() only appends.
+ */
+class BondAllowlist {
+public:
+    /**
+     * Reloads the cache from the stack's bond table.
+     * Allocates a temporary list, so only call it outside the connection hot path.
+     * @return number of bonded devices loaded
+     */
+    uint8_t load();
+
+    bool contains(const esp_bd_addr_t address) const;
+
+    /**
+     * Adds a newly bonded address (no-op if already present).
+     * @param type identity address type, needed to put the peer in the controller whitelist
+     * @return false if the cache is full
+     */
+    bool add(const esp_bd_addr_t address, esp_ble_addr_type_t type = BLE_ADDR_TYPE_PUBLIC);
+
+    /**
+     * Drops one address (revocation, eviction).
+     * @return false if it was not in the cache
+     */
+    bool remove(const esp_bd_addr_t address);
+
+    void clear();
+
+    // Bumped whenever entries disappear, so the controller whitelist knows to rebuild
+    uint32_t revision() const { return removals.load(std::memory_order_acquire); }
+
+    uint8_t size() const { return count.load(std::memory_order_acquire); }
+    bool isEmpty() const { return size() == 0; }
+
+    // Address of entry `index`, valid for index < size(). Loop task only.
+    const uint8_t *addressAt(uint8_t index) const { return entries[index]; }
+    esp_ble_addr_type_t addressTypeAt(uint8_t index) const { return types[index]; }
+
+private:
+    int8_t indexOf(const esp_bd_addr_t address) const; // Caller holds the lock, -1 if absent
+
+    esp_bd_addr_t entries[MAX_BONDED_DEVICES] = {};
+    esp_ble_addr_type_t types[MAX_BONDED_DEVICES] = {};
+    std::atomic<uint8_t> count{0};
+    std::atomic<uint32_t> removals{0};
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Telemetry.h"
+
+// Boot milestones, in the order they are reached
+enum BootPhase : uint8_t {
+    BOOT_SETUP,         // setup() entered
+    BOOT_BLE_READY,     // ble::init() returned: controller and host stack up
+    BOOT_GATT_READY,    // Service started and security configured
+    BOOT_ADVERTISING,   // Advertising for the bonded devices, or no bonds to advertise for
+    BOOT_DEFERRED_DONE, // Display, bond listing and boot messages done on the loop task
+    BOOT_PHASE_COUNT
+};
+
+/**
+ * When each boot phase was reached, as latencyTimestamp() (microseconds since power on).
+ * setup() only does what advertising needs and leaves the rest to the loop task, so
+ * BOOT_ADVERTISING is the time after a power blip before a bonded phone can reconnect;
+ * it is exported with the telemetry counters to be tracked as a regression budget.
+ * Loop task only.
+ */
+class BootTimeline {
+public:
+    void mark(BootPhase phase) { stamps[phase] = latencyTimestamp(); }
+
+    // 0 until the phase is reached
+    uint32_t at(BootPhase phase) const { return stamps[phase]; }
+
+    void dump(Print &out) const;
+
+private:
+    uint32_t stamps[BOOT_PHASE_COUNT] = {};
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+#include <climits>
+
+enum class ButtonEventType : uint8_t {
+    None,
+    ShortPress,        // Released quickly, before any hold action
+    HoldCountdown,     // Whole seconds left until the hold action; sent on press and every second
+    HoldCancelled,     // Released after the countdown started but before the hold completed
+    PairingHold,       // Held for the pairing duration
+    FactoryResetHold,  // Held for the factory reset duration, press started at boot
+};
+
+struct ButtonEvent {
+    ButtonEventType type;
+    uint8_t secondsRemaining; // Only meaningful for HoldCountdown
+};
+
+/**
+ * Interrupt driven button handling.
+ * The GPIO edge interrupt only timestamps the edge and wakes the loop task; debouncing
+ * and the long-press timing are a small state machine advanced by poll(). Nothing here
+ * blocks, and millisUntilNextPoll() tells loop() how long it may sleep.
+ *
+ * A press that is already in progress when begin() runs counts towards the factory
+ * reset hold instead of the pairing hold, like holding the button while powering up.
+ */
+class ButtonMonitor {
+public:
+    ButtonMonitor(uint8_t pin, unsigned long pairingHoldMillis, unsigned long factoryResetHoldMillis);
+
+    /**
+     * Configures the pin and attaches the edge interrupt.
+     * @param wakeTask task notified on every edge (usually the loop task), may be nullptr
+     */
+    void begin(TaskHandle_t wakeTask);
+
+    // Advances the state machine; call until it returns ButtonEventType::None.
+    ButtonEvent poll(unsigned long now);
+
+    // Time until poll() has something new to do, ULONG_MAX while idle
+    unsigned long millisUntilNextPoll(unsigned long now) const;
+
+    bool isPressed() const { return pressed; }
+
+    // True while the current press counts towards the factory reset hold
+    bool isResetHold() const { return pressed && resetHold; }
+
+private:
+    static void IRAM_ATTR onEdge(void *arg);
+
+    unsigned long holdTarget() const { return resetHold ? factoryResetHoldMillis : pairingHoldMillis; }
+
+    const uint8_t pin;
+    const unsigned long pairingHoldMillis;
+    const unsigned long factoryResetHoldMillis;
+    TaskHandle_t wakeTask = nullptr;
+
+    // Written by the ISR
+    volatile bool edgePending = false;
+    volatile unsigned long edgeMillis = 0;
+
+    bool debouncing = false;
+    unsigned long debounceStart = 0;
+    bool pressed = false;          // Debounced level
+    bool bootCheck = false;        // First debounced press decides the factory reset hold
+    bool resetHold = false;
+    bool holdDone = false;         // Hold action reported, wait for release
+    unsigned long pressStart = 0;
+    uint8_t lastSecondsReported = UINT8_MAX;
+};
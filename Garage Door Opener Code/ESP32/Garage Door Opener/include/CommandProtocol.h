@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Binary command framing for the control characteristic.
+ *
+ * A write carries one or more frames back to back:
+ *
+ *   [version][opcode][seq][flags][length][payload: length bytes]
+ *
+ * Every command is answered with a fixed size Reply carrying the same seq, so a client
+ * can pipeline commands with write-without-response and match the answers up.
+ * Writes whose first byte is not PROTOCOL_VERSION are treated as legacy text commands.
+ */
+
+constexpr uint8_t PROTOCOL_VERSION = 0x01; // Never a printable character, so text commands can't collide
+constexpr size_t FRAME_HEADER_SIZE = 5;
+
+enum Opcode : uint8_t {
+    OP_TRIGGER = 0x01, // Pulse the relay
+    OP_STATUS  = 0x02, // Report relay/pairing/bond state
+    // Tune the sender's own connection profile, kept across reconnects:
+    //   [kind u8: 0 fast, 1 idle][min interval u16][max interval u16][latency u8][timeout u16]
+    // A lone kind byte puts that profile back to the default. Reply data: the negotiated
+    // interval u16 and latency u8 of the link so far.
+    OP_CONN_PROFILE = 0x03,
+    // Download the door event log: [from sequence u32], optional, the oldest record kept by
+    // default. Reply data: how many records follow, u32. They arrive as notifications on the
+    // audit characteristic, each holding as many whole AuditRecords as the link's MTU allows.
+    OP_AUDIT_READ = 0x04,
+    // Name the sender in the device registry: [name: 0..8 bytes], empty clears it
+    OP_DEVICE_NAME = 0x05,
+    // Revoke a bonded device without a restart: [address: 6 bytes]. The device is disconnected
+    // and its keys dropped; advertising carries on for the others. Reply data[0]: bonds left.
+    OP_DEVICE_REVOKE = 0x06,
+    // Door position. The same reply is pushed with seq 0 to every authenticated link when the
+    // state changes, and is what a plain read of the characteristic returns. Reply data:
+    // DoorState u8, transition counter u8 (wraps; a gap means a missed notification).
+    OP_DOOR_STATUS = 0x07,
+};
+
+// Frame flags
+constexpr uint8_t FLAG_NO_REPLY = 0x01; // Suppress the reply for this command
+
+enum ReplyStatus : uint8_t {
+    STATUS_OK             = 0x00,
+    STATUS_ACCEPTED       = 0x01, // Trigger queued on the actuator
+    STATUS_ENERGIZED      = 0x02, // Progress: relay switched on
+    STATUS_RELEASED       = 0x03, // Progress: relay switched off
+    STATUS_COALESCED      = 0x04, // Trigger merged into the pulse already running; progress follows
+    STATUS_BUSY           = 0x10,
+    STATUS_UNKNOWN_OPCODE = 0x11,
+    STATUS_MALFORMED      = 0x12,
+    STATUS_NOT_AUTHORIZED = 0x13,
+    STATUS_INVALID_PARAM  = 0x14, // Well formed, but the values are out of range
+};
+
+// Bits in Reply::data[0] of an OP_STATUS reply
+constexpr uint8_t STATE_RELAY_BUSY     = 0x01;
+constexpr uint8_t STATE_PAIRING_ACTIVE = 0x02;
+constexpr uint8_t STATE_CONNECTED      = 0x04;
+
+struct __attribute__((packed)) Reply {
+    uint8_t version;
+    uint8_t seq;
+    uint8_t opcode;
+    uint8_t status;
+    uint8_t data[4]; // Opcode specific, zero when unused
+};
+static_assert(sizeof(Reply) == 8, "Reply must stay 8 bytes on the air");
+
+// One parsed frame. payload points into the caller's buffer, nothing is copied.
+struct CommandView {
+    uint8_t opcode;
+    uint8_t seq;
+    uint8_t flags;
+    uint8_t length;
+    const uint8_t *payload;
+};
+
+// Largest payload carried by a CommandRecord
+constexpr uint8_t MAX_COMMAND_PAYLOAD = 8;
+
+// Owned copy of a parsed command, small enough to pass between tasks by value
+struct CommandRecord {
+    uint8_t opcode;
+    uint8_t seq;
+    uint8_t flags;
+    uint8_t length;
+    uint8_t payload[MAX_COMMAND_PAYLOAD];
+};
+
+/**
+ * Walks the frames of a single write in place.
+ * The buffer must stay valid while the reader and the returned views are in use.
+ */
+class FrameReader {
+public:
+    FrameReader(const uint8_t *data, size_t length) : data(data), length(length) {}
+
+    // True when the buffer starts like a binary frame rather than a text command
+    static bool isBinary(const uint8_t *data, size_t length) {
+        return length >= 1 && data[0] == PROTOCOL_VERSION;
+    }
+
+    /**
+     * Parses the next frame.
+     * @return false at the end of the buffer or on a truncated/invalid frame; malformed() tells them apart
+     */
+    bool next(CommandView &command);
+
+    bool malformed() const { return error; }
+
+    // Sequence number of the frame that failed to parse, if its header was readable
+    uint8_t lastSeq() const { return errorSeq; }
+
+private:
+    const uint8_t *data;
+    size_t length;
+    size_t offset = 0;
+    bool error = false;
+    uint8_t errorSeq = 0;
+};
+
+Reply makeReply(uint8_t seq, uint8_t opcode, ReplyStatus status);
+
+/**
+ * Copies a parsed command out of the write buffer.
+ * @return false if the payload does not fit in a CommandRecord
+ */
+bool toRecord(const CommandView &command, CommandRecord &record);
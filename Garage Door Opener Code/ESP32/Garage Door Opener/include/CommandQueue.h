@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "BleEvent.h"
+#include "ConnectionTable.h"
+
+/**
+ * Commands waiting for loop(), one lane per connection, served round-robin.
+ * A peer that batches many frames into one write only gets every other turn while
+ * another peer has commands waiting, so nobody's trigger sits behind someone else's
+ * burst of status polls. Loop task only, no locking.
+ */
+class CommandQueue {
+public:
+    static constexpr uint8_t LANE_DEPTH = 16; // One full write of frames per connection
+
+    // @return false if that connection's lane is full (or all lanes are taken)
+    bool push(const BleEvent &event);
+
+    // Next command, rotating across connections
+    bool pop(BleEvent &event);
+
+    // Forgets a connection's pending commands, e.g. after it disconnects
+    void drop(uint16_t connId);
+
+    size_t size() const;
+
+private:
+    struct Lane {
+        bool used;
+        uint16_t connId;
+        uint8_t head;
+        uint8_t count;
+        BleEvent items[LANE_DEPTH];
+    };
+
+    Lane lanes[MAX_CONNECTIONS] = {};
+    uint8_t nextLane = 0;
+};
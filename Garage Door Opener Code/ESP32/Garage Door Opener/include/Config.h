@@ -0,0 +1,112 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "esp_heap_caps.h"
+
+// Pins, UUIDs and timing constants shared by the firmware modules
+
+// GPIO pin connected to the relay that controls the garage door
+#define RELAY_PIN 12
+// #define BUTTON_PIN 27
+#define BUTTON_PIN 13
+
+// How long the relay is held energized for one trigger, independent of the display animation
+constexpr uint32_t RELAY_PULSE_MILLIS = 500;
+
+// Optional door position switches (reed or limit switch to GND, internal pull-ups); -1 when not fitted.
+// Without the closed switch the door state stays Unknown. A fitted switch is opted into from the
+// build flags, e.g. -D DOOR_CLOSED_GPIO=27: an unconnected pull-up would read as an open door.
+#ifndef DOOR_CLOSED_GPIO
+#define DOOR_CLOSED_GPIO -1
+#endif
+#ifndef DOOR_OPEN_GPIO
+#define DOOR_OPEN_GPIO -1
+#endif
+constexpr int8_t DOOR_CLOSED_PIN = DOOR_CLOSED_GPIO;
+constexpr int8_t DOOR_OPEN_PIN = DOOR_OPEN_GPIO;
+constexpr unsigned long DOOR_TRAVEL_MILLIS = 20000;        // A full run of the door, with margin
+constexpr unsigned long DOOR_NOTIFY_COALESCE_MILLIS = 250; // Transitions inside this window share one notification
+
+// GPIO pins for the MAX7219 LED Matrix 8 digit display
+constexpr int DIN_PIN = 21;
+constexpr int CS_PIN  = 19;
+constexpr int CLK_PIN = 18;
+
+// UUID generator : https://www.uuidgenerator.net/
+#define SERVICE_UUID        "9ba08ea3-3fa9-4622-bae5-bdd3f0c7fedf" // Example Service UUID
+#define CHARACTERISTIC_UUID "427c5c12-0f90-46be-ba43-7e4a207be489" // Example Characteristic UUID
+#define STATS_CHARACTERISTIC_UUID "1eca60aa-9a92-4339-94a5-0a6b5bd4ecee" // Read-only telemetry blob
+#define AUDIT_CHARACTERISTIC_UUID "712bb240-4e8f-45f4-9696-e5ce0d565cf0" // Notify-only audit log download
+#define DEVICES_CHARACTERISTIC_UUID "c7e32372-ab1b-4e7a-b9e0-c05a082c81a6" // Read-only device registry
+
+// Commands beyond this many in one write are dropped
+constexpr size_t MAX_COMMANDS_PER_WRITE = 16;
+
+//pairing button
+constexpr unsigned long PAIRING_PRESS_DURATION_MILLIS = 5000; // 5 seconds
+constexpr unsigned long PAIRING_WINDOW_TIMEOUT_MILLIS = 60000; // Advertising active for 60 seconds if no connection
+constexpr unsigned long FACTORY_RESET_PRESS_DURATION = 5000; // 5 seconds for factory reset
+constexpr unsigned long PAIRING_TIMEOUT_RECHECK_MILLIS = 1000; // Timeout is deferred while a device is connected
+
+constexpr unsigned long DISPLAY_CLEAR_MILLIS = 5000;    // Status text is cleared after this long
+constexpr unsigned long REJECT_DISPLAY_MILLIS = 1000;   // How long rejection messages stay up
+constexpr unsigned long READVERTISE_DELAY_MILLIS = 500; // Give the BLE stack time to reset after a disconnect
+
+// Whitelist-only advertising outside the pairing window, opted into with -D FILTERED_ADVERTISING.
+// Phones connect from resolvable private addresses while the whitelist holds identity addresses;
+// the controller only matches the two with address resolution on and the bonds' IRKs in its
+// resolving list, which neither backend sets up yet. Until that is checked on hardware the
+// onConnect allowlist check does the filtering alone.
+#ifdef FILTERED_ADVERTISING
+constexpr bool ADVERTISING_FILTER_ENABLED = true;
+#else
+constexpr bool ADVERTISING_FILTER_ENABLED = false;
+#endif
+
+// A link with no command for this long moves from the fast to the idle connection profile
+constexpr unsigned long CONN_IDLE_AFTER_MILLIS = 5000;
+
+// Door event log, see AuditLog and partitions.csv
+constexpr const char *AUDIT_PARTITION_LABEL = "audit";
+constexpr uint8_t AUDIT_PARTITION_SUBTYPE = 0x40; // First subtype free for applications
+constexpr uint8_t AUDIT_BATCH_RECORDS = 16;       // Records per flash write
+constexpr unsigned long AUDIT_FLUSH_MILLIS = 60000; // Longest a record waits in RAM
+// Download: notifications of as many records as the peer's MTU takes, a few per connection event
+constexpr uint16_t AUDIT_LOCAL_MTU = 517;
+constexpr uint8_t AUDIT_STREAM_CHUNKS_PER_STEP = 4;
+constexpr unsigned long AUDIT_STREAM_STEP_MILLIS = 15;
+
+// Device registry, see DeviceRegistry
+constexpr uint8_t DEVICE_NAME_LEN = 8;                // One OP_DEVICE_NAME payload
+constexpr unsigned long REGISTRY_SAVE_MILLIS = 60000; // Last-seen and trigger counts are written this late at most
+constexpr unsigned long REGISTRY_PUBLISH_MILLIS = 1000; // Changes inside this window share one characteristic refresh
+constexpr unsigned long STATS_REFRESH_MILLIS = 1000; // Age of the stats characteristic at most while a link is up
+
+// Scheduler slots; handlers are registered in setup() and run on the loop task
+enum TimerSlot : uint8_t {
+    TIMER_DISPLAY, // Next display frame or expiry
+    TIMER_PAIRING_TIMEOUT,
+    TIMER_READVERTISE,
+    TIMER_CONN_IDLE,
+    TIMER_DEFERRED_INIT,
+    TIMER_AUDIT_FLUSH,
+    TIMER_AUDIT_STREAM,
+    TIMER_REGISTRY_SAVE,
+    TIMER_DOOR_NOTIFY,
+    TIMER_REGISTRY_PUBLISH,
+    TIMER_STATS_REFRESH,
+};
+
+// Heap the firmware draws on; the BLE controller's DMA buffers are excluded
+constexpr uint32_t TRACKED_HEAP_CAPS = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+
+// BLE callbacks -> loop(). The BLE host task is the only producer, loop() the only consumer.
+// Holds a full write of commands from every link at once, see the check in AppState.h.
+constexpr size_t BLE_EVENT_QUEUE_SIZE = 64;
+
+// Log records from any task -> the low priority log task, which formats them to Serial
+constexpr size_t LOG_QUEUE_SIZE = 64;
+constexpr uint32_t LOG_TASK_STACK_BYTES = 3072;
+constexpr UBaseType_t LOG_TASK_PRIORITY = 0; // Idle priority: below loop() (Arduino's loopTask runs at 1) and the BLE stack
+constexpr unsigned long LOG_DRAIN_MILLIS = 20; // Polled, so producers never pay for a task notification
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include <climits>
+
+#include "esp_gap_ble_api.h"
+#include "BleEvent.h"
+#include "ConnectionTable.h"
+
+// Connection parameters in the units the controller uses
+struct ConnProfile {
+    uint16_t minInterval; // 1.25 ms units, 6..3200
+    uint16_t maxInterval; // 1.25 ms units, minInterval..3200
+    uint16_t latency;     // Connection events the peripheral may skip, 0..499
+    uint16_t timeout;     // Supervision timeout, 10 ms units, 10..3200
+};
+
+enum class ConnProfileKind : uint8_t {
+    Fast, // Just authenticated or a command just arrived: the next command lands within one short interval
+    Idle, // Nothing to do: long interval plus peripheral latency keep the radio mostly off
+    Count
+};
+
+// Defaults stay inside Apple's accessory guidelines (interval >= 15 ms, max * (latency + 1) <= 2 s,
+// timeout 2-6 s) so iOS centrals accept them as well as Android ones.
+// 15 ms, no latency, 2 s timeout
+constexpr ConnProfile DEFAULT_FAST_PROFILE = {12, 12, 0, 200};
+// 100-200 ms, 4 skipped events (a command waits at most ~1 s), 6 s timeout
+constexpr ConnProfile DEFAULT_IDLE_PROFILE = {80, 160, 4, 600};
+
+/**
+ * Picks the connection parameters of every authenticated link.
+ *
+ * A link starts on the fast profile once encryption completes, drops to the idle profile
+ * after CONN_IDLE_AFTER_MILLIS without a command and goes back to fast on the next command.
+ * Each bonded device may override either profile; overrides live in NVS keyed by address
+ * and are read once per connection.
+ *
+ * Loop task only. The requests go out with ble::updateConnParams(); the central
+ * has the last word, so the values it settles on are recorded per link.
+ */
+class ConnParamManager {
+public:
+    // Starts managing a link that just authenticated and asks for the fast profile
+    void onAuthenticated(uint16_t connId, const esp_bd_addr_t address, unsigned long now);
+
+    // A command arrived; back to the fast profile if the link was idling
+    void onActivity(uint16_t connId, unsigned long now);
+
+    void onDisconnected(uint16_t connId);
+
+    void onNegotiated(uint16_t connId, const BleConnParams &params);
+
+    // Moves links that stayed quiet long enough to the idle profile
+    void idleDue(unsigned long now);
+
+    // Time until the next link is due to idle, ULONG_MAX if none
+    unsigned long millisUntilIdle(unsigned long now) const;
+
+    /**
+     * Stores an override for one bonded device and applies it if that device's link is on the profile.
+     * @return false if the values are outside what the Core specification allows
+     */
+    bool setProfile(const esp_bd_addr_t address, ConnProfileKind kind, const ConnProfile &profile);
+
+    // Drops the override, back to the default
+    void resetProfile(const esp_bd_addr_t address, ConnProfileKind kind);
+
+    // Drops both overrides of one device (revocation)
+    void forgetProfiles(const esp_bd_addr_t address);
+
+    // Drops every override (factory reset)
+    void clearProfiles();
+
+    // @return false if the link is not managed
+    bool negotiated(uint16_t connId, BleConnParams &params) const;
+    bool currentProfile(uint16_t connId, ConnProfileKind &kind) const;
+
+    static bool isValid(const ConnProfile &profile);
+
+private:
+    struct Link {
+        bool used;
+        uint16_t connId;
+        esp_bd_addr_t address;
+        ConnProfileKind kind;
+        unsigned long lastActivity;
+        ConnProfile profiles[static_cast<uint8_t>(ConnProfileKind::Count)];
+        BleConnParams negotiated; // Zero until the first report
+    };
+
+    Link *linkFor(uint16_t connId);
+    const Link *linkFor(uint16_t connId) const;
+    void request(Link &link, ConnProfileKind kind);
+
+    Link links[MAX_CONNECTIONS] = {};
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "esp_gap_ble_api.h"
+#include "BleBackend.h"
+
+// Simultaneous links the controller accepts (Bluedroid's BLE connection limit)
+#ifdef CONFIG_BTDM_CTRL_BLE_MAX_CONN
+constexpr uint8_t MAX_CONNECTIONS = CONFIG_BTDM_CTRL_BLE_MAX_CONN;
+#else
+constexpr uint8_t MAX_CONNECTIONS = 3;
+#endif
+
+enum class LinkState : uint8_t {
+    Free,
+    Connected,     // Link up, encryption requested
+    Authenticated, // Encrypted with a bonded key, commands are accepted
+};
+
+struct Connection {
+    uint16_t connId;
+    LinkState state;
+    esp_bd_addr_t address;
+    uint32_t connectedAt; // latencyTimestamp() of onConnect
+    uint32_t encryptionRequestedAt; // Start of the encrypt->auth span, 0 once it was recorded
+    uint8_t subscriptions; // Bit per BleCharacteristic whose notifications the peer enabled in its CCCD
+};
+static_assert(static_cast<uint8_t>(BleCharacteristic::Count) <= 8, "Connection::subscriptions has a bit per characteristic");
+
+/**
+ * Fixed table of the current links, keyed by conn_id.
+ * Written by the BLE task as links come, authenticate and go; read by loop() and the
+ * security callbacks. A spinlock keeps each lookup consistent across the two tasks.
+ *
+ * The security callbacks are not told which link they are about, so pairingCandidate()
+ * names the newest link that has not authenticated yet: bonded peers re-encrypt without a
+ * passkey, which leaves the one doing a fresh pairing.
+ */
+class ConnectionTable {
+public:
+    // @return false if every slot is taken
+    bool add(uint16_t connId, const esp_bd_addr_t address, uint32_t now);
+    void remove(uint16_t connId);
+
+    void authenticate(uint16_t connId);
+
+    void encryptionRequested(uint16_t connId, uint32_t now);
+    /**
+     * Hands out the link's encryption request time once, for the encrypt->auth span.
+     * @return false if the link is unknown or the span was already taken
+     */
+    bool takeEncryptionRequestedAt(uint16_t connId, uint32_t &requestedAt);
+
+    // CCCD writes are per link: a new link starts with every notification off
+    void setSubscribed(uint16_t connId, BleCharacteristic characteristic, bool subscribed);
+    bool isSubscribed(uint16_t connId, BleCharacteristic characteristic) const;
+
+    bool find(uint16_t connId, Connection &connection) const;
+    bool findByAddress(const esp_bd_addr_t address, uint16_t &connId) const;
+    bool isAuthenticated(uint16_t connId) const;
+    bool pairingCandidate(uint16_t &connId) const;
+
+    /**
+     * Snapshot of the links that may receive door state, e.g. to push a notification to each.
+     * @return how many conn_ids were written
+     */
+    uint8_t authenticated(uint16_t (&connIds)[MAX_CONNECTIONS]) const;
+
+    uint8_t count() const;
+    bool isFull() const { return count() >= MAX_CONNECTIONS; }
+
+    void clear();
+
+private:
+    Connection *slotFor(uint16_t connId);
+    const Connection *slotFor(uint16_t connId) const;
+
+    Connection entries[MAX_CONNECTIONS] = {};
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "esp_gap_ble_api.h"
+#include "BondAllowlist.h"
+#include "Config.h"
+#include "ConnectionTable.h"
+
+// One registered device, as stored in NVS and served on the devices characteristic
+struct __attribute__((packed)) DeviceRecord {
+    esp_bd_addr_t address;
+    char name[DEVICE_NAME_LEN]; // Chosen by the device, zero padded, not terminated when full
+    uint32_t lastSeen;          // Registry tick of the last authenticated connection, 0 if never
+    uint32_t triggerCount;
+};
+static_assert(sizeof(DeviceRecord) == 22, "DeviceRecord is part of the NVS blob and the GATT format");
+
+/**
+ * Application-level record of every bonded device, kept next to the keys the BLE stack stores.
+ *
+ * Records sit in a fixed array with an open addressing index over their addresses, so the
+ * lookup on every connect and trigger is O(1). The whole registry is a single NVS blob;
+ * changes only mark it dirty and the caller saves on a timer, so a burst of triggers costs
+ * one flash write. The board has no wall clock: lastSeen is a tick that counts authenticated
+ * connections across reboots, which is all LRU eviction needs.
+ *
+ * Loop task only.
+ */
+class DeviceRegistry {
+public:
+    DeviceRegistry() { rebuildIndex(); }
+
+    // Reads the blob, then drops records whose bond is gone and adds bonds that have no record
+    void load(const BondAllowlist &bonds);
+
+    /**
+     * Writes the blob if anything changed since the last save.
+     * @return false if NVS refused the write; the registry stays dirty
+     */
+    bool save();
+
+    // Forgets every device, the stored blob included (factory reset)
+    void clear();
+
+    const DeviceRecord *find(const esp_bd_addr_t address) const;
+
+    /**
+     * Marks a device as just seen, adding it if it is new.
+     * @return false if the registry is full
+     */
+    bool touch(const esp_bd_addr_t address);
+
+    void countTrigger(const esp_bd_addr_t address);
+
+    // @return false for an unknown device
+    bool setName(const esp_bd_addr_t address, const uint8_t *name, size_t length);
+
+    // @return false for an unknown device
+    bool remove(const esp_bd_addr_t address);
+
+    // Least recently seen device without a live link, nullptr if every device is connected
+    const DeviceRecord *leastRecentlySeen(const ConnectionTable &connections) const;
+
+    uint8_t size() const { return count; }
+    const DeviceRecord &at(uint8_t index) const { return records[index]; }
+    bool isDirty() const { return dirty; }
+    uint32_t writeCount() const { return writes; }
+
+    /**
+     * Copies the records back to back, the devices characteristic format.
+     * @return bytes written, 0 if capacity is too small
+     */
+    size_t serialize(uint8_t *out, size_t capacity) const;
+
+    // Human readable table for the serial console
+    void dump(Print &out) const;
+
+private:
+    static constexpr uint8_t INDEX_SLOTS = 32;
+    static constexpr int8_t NO_RECORD = -1;
+    static_assert((INDEX_SLOTS & (INDEX_SLOTS - 1)) == 0, "Index size must be a power of two");
+    static_assert(INDEX_SLOTS >= 2 * MAX_BONDED_DEVICES, "Keep the index at most half full so probes stay short");
+
+    static uint8_t hash(const esp_bd_addr_t address);
+    int8_t indexOf(const esp_bd_addr_t address) const;
+    DeviceRecord *add(const esp_bd_addr_t address);
+    void rebuildIndex();
+
+    DeviceRecord records[MAX_BONDED_DEVICES] = {};
+    int8_t index[INDEX_SLOTS]; // records[] position per hash slot, NO_RECORD when free
+    uint8_t count = 0;
+    uint32_t tick = 0;
+    bool dirty = false;
+    uint32_t writes = 0;
+};
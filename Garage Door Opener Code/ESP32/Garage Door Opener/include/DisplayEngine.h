@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+#include <climits>
+
+#include "Max7219Display.h"
+
+// One keyframe: the raw segments of every digit (bit 7 = DP, bit 6 = A ... bit 0 = G, digit 0 rightmost)
+struct AnimationFrame {
+    uint8_t segments[MAX7219_DIGITS];
+    uint16_t durationMillis;
+};
+
+// Constant frame table; define instances constexpr so they stay in flash
+struct Animation {
+    const AnimationFrame *frames;
+    uint8_t frameCount;
+    bool loop; // Start over after the last frame instead of leaving the layer
+};
+
+// Display layers, lowest priority first; the highest active layer is what the chip shows
+enum class DisplayLayer : uint8_t {
+    Idle,    // Background animation
+    Status,  // Status text and activity animations, newest wins
+    Passkey, // Pairing passkey, stays until cleared
+    Count
+};
+
+/**
+ * Keyframe animation engine for the MAX7219 display.
+ *
+ * Every layer holds either static segments or an animation, and may expire after a
+ * hold time. Nothing blocks: tick() advances the frames that are due and reports when
+ * it next needs to run, and the caller drives it from a scheduler slot. A frame change
+ * costs one compare and a flush of the digits that differ.
+ *
+ * Loop task only.
+ */
+class DisplayEngine {
+public:
+    explicit DisplayEngine(Max7219Display &display) : display(display) {}
+
+    /**
+     * Puts static segments on a layer.
+     * @param holdMillis how long the layer stays up, 0 for until clear()
+     * @return digit registers sent to the chip
+     */
+    uint8_t show(DisplayLayer layer, const uint8_t (&segments)[MAX7219_DIGITS], unsigned long holdMillis, unsigned long now);
+
+    /**
+     * Starts an animation on a layer from its first frame.
+     * @param holdMillis how long a looping animation runs, 0 for until clear(); a one-shot
+     *                   animation leaves the layer after its last frame regardless
+     */
+    void play(DisplayLayer layer, const Animation &animation, unsigned long holdMillis, unsigned long now);
+
+    // Cancels whatever the layer shows; the layer below becomes visible
+    void clear(DisplayLayer layer);
+
+    bool isActive(DisplayLayer layer) const;
+    bool isPlaying(DisplayLayer layer, const Animation &animation) const;
+
+    // Advances due frames and expires layers, then redraws
+    void tick(unsigned long now);
+
+    // Time until tick() has work to do, ULONG_MAX if nothing is animating or expiring
+    unsigned long millisUntilTick(unsigned long now) const;
+
+private:
+    struct Layer {
+        bool active;
+        const Animation *animation; // nullptr for static segments
+        uint8_t frame;
+        unsigned long frameStartedAt;
+        unsigned long expiresAt;
+        bool expires;
+        uint8_t segments[MAX7219_DIGITS];
+    };
+
+    // Pushes the topmost active layer to the chip
+    uint8_t render();
+
+    Max7219Display &display;
+    Layer layers[static_cast<uint8_t>(DisplayLayer::Count)] = {};
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Arduino.h>
+#include <climits>
+
+// Door position as reported on the control characteristic; stored as a byte, append only
+enum class DoorState : uint8_t {
+    Unknown, // No sensor fitted, or between the limits with nothing known about how it got there
+    Closed,
+    Open,
+    Moving,  // Left a limit or the relay pulsed, within the travel time
+    Fault,   // Travel time ran out, or both limits report at once
+};
+
+/**
+ * Door position from one or two limit switches (reed or microswitch to GND, internal pull-up).
+ *
+ * The closed-position switch is required for sensing, the open-position one is optional.
+ * Like ButtonMonitor, the edge interrupt only timestamps the edge and wakes the loop task;
+ * poll() debounces both inputs and derives the state:
+ *
+ *   - at a limit: Closed / Open, unless the relay pulsed and the door never left it
+ *     within the travel time (Fault)
+ *   - between the limits after leaving one or after a pulse: Moving until the travel
+ *     time runs out, then Open with a single switch (not closed is all it knows) or
+ *     Fault with two (the door should have reached the other limit)
+ *
+ * Loop task only, apart from the ISR.
+ */
+class DoorSensor {
+public:
+    // @param openPin -1 when only the closed position is sensed; closedPin -1 disables sensing
+    DoorSensor(int8_t closedPin, int8_t openPin, unsigned long travelMillis);
+
+    /**
+     * Configures the pins, attaches the edge interrupts and takes the levels as they are.
+     * @param wakeTask task notified on every edge (usually the loop task), may be nullptr
+     */
+    void begin(TaskHandle_t wakeTask, unsigned long now);
+
+    bool isFitted() const { return closed.pin >= 0; }
+
+    // The relay just pulsed: the door should move and reach a limit within the travel time
+    void onPulse(unsigned long now);
+
+    /**
+     * Debounces the inputs and advances the travel timeout.
+     * @return true if state() changed
+     */
+    bool poll(unsigned long now);
+
+    // Time until poll() has something new to do, ULONG_MAX while nothing is pending
+    unsigned long millisUntilNextPoll(unsigned long now) const;
+
+    DoorState state() const { return current; }
+
+    // Transitions since boot, wrapping; lets a client spot notifications it missed
+    uint8_t transitions() const { return transitionCount; }
+
+private:
+    struct Input {
+        int8_t pin;
+        DoorSensor *owner;
+        volatile bool edgePending;
+        volatile unsigned long edgeMillis;
+        bool debouncing;
+        unsigned long debounceStart;
+        bool active; // Debounced: the switch is made
+    };
+
+    static void IRAM_ATTR onEdge(void *arg);
+
+    void setup(Input &input);
+    // @return true if the debounced level changed
+    bool debounce(Input &input, unsigned long now);
+    bool travelExpired(unsigned long now) const { return now - travelStart >= travelMillis; }
+    DoorState evaluate(unsigned long now) const;
+
+    Input closed;
+    Input open;
+    const unsigned long travelMillis;
+    TaskHandle_t wakeTask = nullptr;
+
+    bool travelling = false;  // A travel timeout is running
+    bool pulseAtLimit = false; // It was started by a pulse while the door sat at a limit
+    unsigned long travelStart = 0;
+    DoorState current = DoorState::Unknown;
+    uint8_t transitionCount = 0;
+};
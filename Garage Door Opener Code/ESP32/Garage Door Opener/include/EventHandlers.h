@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "BleEvent.h"
+#include "ButtonMonitor.h"
+
+// Loop task side of the firmware: reactions to BLE and button events and the scheduler handlers.
+
+void handleBleEvent(const BleEvent &event);
+
+// Runs the queued commands, taking turns between connections
+void processCommands();
+void handleButtonEvent(const ButtonEvent &event);
+
+// Reports relay progress in the protocol the running trigger arrived in
+void notifyActuationProgress(ReplyStatus status, const char *text);
+
+void pairingTimeout(); // TIMER_PAIRING_TIMEOUT handler
+void readvertise();    // TIMER_READVERTISE handler
+void connIdle();       // TIMER_CONN_IDLE handler
+void deferredInit();   // TIMER_DEFERRED_INIT handler: boot work that does not gate advertising
+void auditFlush();     // TIMER_AUDIT_FLUSH handler
+void auditStreamStep(); // TIMER_AUDIT_STREAM handler
+void registrySave();   // TIMER_REGISTRY_SAVE handler
+void registryPublish(); // TIMER_REGISTRY_PUBLISH handler
+void doorNotify();     // TIMER_DOOR_NOTIFY handler
+void statsRefresh();   // TIMER_STATS_REFRESH handler
+
+// Caches a new doorSensor.state() for reads and queues its notification
+void handleDoorChange();
+// The same for the position at power up, without the notification
+void initDoorState();
+
+// Arms TIMER_REGISTRY_PUBLISH and TIMER_REGISTRY_SAVE after a registry change
+void registryChanged();
+
+// Copies the gauges owned by other modules into the telemetry counters before an export
+void refreshTelemetryGauges();
+
+void listBondedDevices();
+void clearBondedDevices(); // Wipes the bond table and restarts
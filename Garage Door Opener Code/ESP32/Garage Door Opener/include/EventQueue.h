@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Bounded single-producer/single-consumer ring.
+ * push() is called from exactly one task and pop() from exactly one other task; neither
+ * side locks or allocates. A full ring drops the new item and counts it, so the
+ * producer (the BLE stack's task) is never held up by a slow consumer.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T &item) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[head & (Capacity - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t depth = head + 1 - tail;
+        if (depth > highWater_.load(std::memory_order_relaxed)) highWater_.store(depth, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        if (tail == head) return false;
+        item = items[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Statistics, readable from any task
+    uint32_t pushedCount() const { return pushed_.load(std::memory_order_relaxed); }
+    uint32_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+    uint32_t highWaterMark() const { return highWater_.load(std::memory_order_relaxed); }
+
+private:
+    T items[Capacity];
+    std::atomic<uint32_t> head_{0}; // Next slot to write, producer owned
+    std::atomic<uint32_t> tail_{0}; // Next slot to read, consumer owned
+    std::atomic<uint32_t> pushed_{0};
+    std::atomic<uint32_t> dropped_{0};
+    std::atomic<uint32_t> highWater_{0};
+};
+
+/**
+ * Bounded multi-producer/single-consumer ring (Vyukov's sequence-numbered slots).
+ * Any task may push(): a producer claims a slot with one compare-and-swap on head, fills
+ * it and publishes it by bumping the slot's sequence. pop() belongs to one consumer task.
+ * Nothing locks or allocates; a full ring drops the new item and counts it.
+ *
+ * A producer preempted between claiming and publishing a slot only delays the consumer,
+ * which stops at the first unpublished slot and picks it up on a later pop().
+ */
+template <typename T, size_t Capacity>
+class MpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscRing() {
+        for (uint32_t i = 0; i < Capacity; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Producer side, any task
+    bool push(const T &item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots[head & (Capacity - 1)];
+            const int32_t lag = static_cast<int32_t>(slot->sequence.load(std::memory_order_acquire) - head);
+            if (lag == 0) {
+                if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                // The consumer has not freed this slot yet: full
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                head = head_.load(std::memory_order_relaxed); // Another producer took it
+            }
+        }
+        slot->item = item;
+        slot->sequence.store(head + 1, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item) {
+        Slot &slot = slots[tail_ & (Capacity - 1)];
+        if (static_cast<int32_t>(slot.sequence.load(std::memory_order_acquire) - (tail_ + 1)) < 0) return false;
+        item = slot.item;
+        slot.sequence.store(tail_ + Capacity, std::memory_order_release);
+        tail_++;
+        return true;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Statistics, readable from any task
+    uint32_t pushedCount() const { return pushed_.load(std::memory_order_relaxed); }
+    uint32_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence; // Equal to the position it is free for, one past once published
+        T item;
+    };
+
+    Slot slots[Capacity];
+    std::atomic<uint32_t> head_{0}; // Next slot to claim, shared by the producers
+    uint32_t tail_ = 0;             // Next slot to read, consumer owned
+    std::atomic<uint32_t> pushed_{0};
+    std::atomic<uint32_t> dropped_{0};
+};
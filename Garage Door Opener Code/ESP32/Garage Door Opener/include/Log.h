@@ -0,0 +1,158 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Config.h"
+#include "EventQueue.h"
+
+// Log levels; messages above LOG_LEVEL are compiled out, arguments included
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Every message the firmware logs; the format strings live in Log.cpp, in the same order
+enum LogEvent : uint8_t {
+    LOG_BOOT_BANNER,
+    LOG_BOOT_BONDED,
+    LOG_BOOT_NO_BONDS,
+    LOG_BOND_COUNT,           // count
+    LOG_BOND_ENTRY,           // address
+    LOG_BONDS_CLEARING,
+    LOG_BONDS_CLEARED,
+    LOG_PAIRING_ACTIVE,       // window seconds
+    LOG_PAIRING_TIMED_OUT,    // window seconds
+    LOG_PAIRING_CLOSED,
+    LOG_PAIRING_REJECTED,
+    LOG_PASSKEY,              // passkey
+    LOG_PASSKEY_REQUEST,
+    LOG_CONFIRM_PIN,          // pin
+    LOG_SECURITY_ALLOWED,
+    LOG_SECURITY_REJECTED,
+    LOG_AUTH_OK,              // address
+    LOG_AUTH_FAILED,          // reason
+    LOG_CONNECTED,            // address, status
+    LOG_CONNECT_REJECTED,     // address
+    LOG_DISCONNECTED,         // connId
+    LOG_READVERTISED,
+    LOG_WHITELIST_SHORT,      // whitelisted, bonds
+    LOG_CONN_PARAMS,          // connId, interval us, latency, timeout ms
+    LOG_CONN_PARAMS_FAILED,   // connId, status
+    LOG_BLE_EVENTS_DROPPED,   // total dropped
+    LOG_TRIGGER_ACCEPTED,     // seq
+    LOG_TEXT_TRIGGER_ACCEPTED,
+    LOG_TRIGGER_COALESCED,
+    LOG_RELAY_BUSY,
+    LOG_RELAY_ENERGIZED,
+    LOG_RELAY_RELEASED,
+    LOG_UNKNOWN_OPCODE,       // opcode, seq
+    LOG_UNKNOWN_TEXT,
+    LOG_WRITE_NO_BONDS,
+    LOG_WRITE_UNAUTHENTICATED, // connId
+    LOG_MALFORMED_FRAME,
+    LOG_HOLD_COUNTDOWN,       // seconds
+    LOG_DISPLAY_SENT,         // digits, us
+    LOG_AUDIT_READY,          // records, next sequence
+    LOG_AUDIT_MISSING,
+    LOG_DEVICE_REVOKED,       // address
+    LOG_DEVICE_EVICTED,       // address
+    LOG_REGISTRY_SAVE_FAILED,
+    LOG_DOOR_UNKNOWN,         // One per DoorState, in the same order
+    LOG_DOOR_CLOSED,
+    LOG_DOOR_OPEN,
+    LOG_DOOR_MOVING,
+    LOG_DOOR_FAULT,
+    LOG_BLE_FOOTPRINT,        // init us, heap bytes, image bytes
+    LOG_EVENT_COUNT
+};
+
+constexpr uint8_t LOG_MAX_ARGS = 4;
+
+// One message as it sits in the ring: formatting waits for the log task
+struct LogRecord {
+    uint32_t millis;
+    uint8_t level;
+    LogEvent event;
+    bool address; // args[0..1] hold a Bluetooth address, printed in place of the first argument
+    uint32_t args[LOG_MAX_ARGS];
+};
+
+/**
+ * Deferred logger. write() stamps the time and stores the event id and its raw arguments
+ * in a lock-free ring, which any task may do without ever touching the UART. The log task
+ * started by begin() formats and prints the records at low priority; a full ring drops
+ * new records and the next drain reports how many were lost.
+ *
+ * Use the LOG_* macros rather than calling write() so disabled levels cost nothing.
+ */
+class Logger {
+public:
+    // Starts the log task that drains to out every LOG_DRAIN_MILLIS
+    void begin(Print &out);
+
+    void write(uint8_t level, LogEvent event, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0, uint32_t d = 0);
+    void writeAddress(uint8_t level, LogEvent event, const uint8_t *address, uint32_t a = 0, uint32_t b = 0);
+
+    /**
+     * Formats the pending records to out. Only one caller drains at a time; a second one
+     * returns 0 straight away.
+     * @return records printed
+     */
+    size_t drain(Print &out);
+
+    /**
+     * Waits for a drain in progress, then empties the ring; for output that must not be
+     * overtaken by queued lines (dumps, restart).
+     * @param direct written after the queued lines while out is still held, so the log task
+     *               cannot cut into it; may be nullptr
+     */
+    void flush(Print &out, void (*direct)(Print &out) = nullptr);
+
+    uint32_t writtenCount() const { return ring.pushedCount(); }
+    uint32_t droppedCount() const { return ring.droppedCount(); }
+
+private:
+    static void task(void *arg);
+    size_t drainLocked(Print &out);
+
+    MpscRing<LogRecord, LOG_QUEUE_SIZE> ring;
+    std::atomic<bool> draining{false};
+    uint32_t reportedDrops = 0; // Owned by whoever holds draining
+    Print *output = nullptr;
+};
+
+// Defined with the other firmware globals in AppState.cpp
+extern Logger logger;
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(event, ...) logger.write(LOG_LEVEL_ERROR, event, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(event, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(event, ...) logger.write(LOG_LEVEL_WARN, event, ##__VA_ARGS__)
+#define LOG_WARN_ADDR(event, address, ...) logger.writeAddress(LOG_LEVEL_WARN, event, address, ##__VA_ARGS__)
+#else
+#define LOG_WARN(event, ...) ((void)0)
+#define LOG_WARN_ADDR(event, address, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(event, ...) logger.write(LOG_LEVEL_INFO, event, ##__VA_ARGS__)
+#define LOG_INFO_ADDR(event, address, ...) logger.writeAddress(LOG_LEVEL_INFO, event, address, ##__VA_ARGS__)
+#else
+#define LOG_INFO(event, ...) ((void)0)
+#define LOG_INFO_ADDR(event, address, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(event, ...) logger.write(LOG_LEVEL_DEBUG, event, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(event, ...) ((void)0)
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+
+constexpr uint8_t MAX7219_DIGITS = 8;
+
+// Timing of Max7219Display::flush(), for comparing the SPI cost of display updates
+struct DisplayTiming {
+    uint32_t flushCount = 0;     // flush() calls that had at least one dirty digit
+    uint32_t skippedFlushes = 0; // flush() calls with nothing to send
+    uint32_t digitsWritten = 0;  // total digit registers pushed to the chip
+    uint32_t lastMicros = 0;     // duration of the most recent non-empty flush
+    uint32_t maxMicros = 0;      // slowest non-empty flush so far
+};
+
+/**
+ * Driver for one MAX7219 wired as an 8 digit 7-segment display.
+ * All drawing calls only touch an 8 byte shadow framebuffer. flush() compares it with
+ * what the chip currently shows and sends just the changed digit registers, back to back
+ * inside a single SPI transaction.
+ *
+ * Digit 0 is the rightmost digit, matching the LedController numbering used before.
+ */
+class Max7219Display {
+public:
+    Max7219Display(int8_t dinPin, int8_t clkPin, int8_t csPin);
+
+    // Sets up the SPI bus and the control registers, blanks the chip, then shows whatever
+    // was drawn before begin(). Until then flush() leaves everything in the framebuffer.
+    void begin(uint8_t intensity);
+
+    void setIntensity(uint8_t intensity);
+
+    // Framebuffer operations, nothing is sent until flush()
+    void clear();
+    void setChar(uint8_t digit, char character, bool decimalPoint);
+    void setSegments(uint8_t digit, uint8_t segments);
+    // Turns one segment line (0 = DP, 1 = A ... 7 = G) on or off across all digits
+    void setColumn(uint8_t column, bool on);
+
+    /**
+     * Pushes the digits that differ from the chip's current contents.
+     * @return number of digit registers written
+     */
+    uint8_t flush();
+
+    const DisplayTiming &timing() const { return stats; }
+
+    // 7-segment pattern for an ASCII character (bit 7 = DP, bit 6 = A ... bit 0 = G)
+    static uint8_t segmentsFor(char character);
+
+private:
+    void writeRegister(uint8_t reg, uint8_t value);
+
+    const int8_t dinPin;
+    const int8_t clkPin;
+    const int8_t csPin;
+    SPIClass spi;
+
+    uint8_t frame[MAX7219_DIGITS] = {};  // what we want shown
+    uint8_t shown[MAX7219_DIGITS] = {};  // what the chip holds
+    bool started = false;                // begin() ran, the bus is up
+    DisplayTiming stats;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <climits>
+
+using TimerCallback = void (*)();
+
+/**
+ * Allocation-free deadline queue owning the firmware's one-shot timeouts.
+ * Each timer is a fixed slot (an index chosen by the caller) with a handler registered
+ * once at startup. Any task may schedule or cancel a slot; handlers always run on the
+ * loop task from runDue(), so BLE callbacks can hand follow-up work to loop() instead of
+ * sleeping inside the stack's task.
+ */
+class Scheduler {
+public:
+    static constexpr uint8_t MAX_TIMERS = 16;
+
+    // @param wakeTask task running runDue(), notified whenever a deadline moves earlier
+    void begin(TaskHandle_t wakeTask);
+
+    void setHandler(uint8_t id, TimerCallback handler);
+
+    // (Re)arms a slot to fire delayMillis from now. Safe from any task.
+    void schedule(uint8_t id, unsigned long delayMillis);
+
+    void cancel(uint8_t id);
+
+    bool isScheduled(uint8_t id) const;
+
+    // Runs the handlers of every expired slot. Loop task only.
+    void runDue(unsigned long now);
+
+    // Time until the earliest armed deadline, ULONG_MAX if nothing is armed
+    unsigned long millisUntilNext(unsigned long now) const;
+
+private:
+    struct Timer {
+        TimerCallback handler = nullptr;
+        unsigned long deadline = 0;
+        bool armed = false;
+    };
+
+    Timer timers[MAX_TIMERS];
+    TaskHandle_t wakeTask = nullptr;
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
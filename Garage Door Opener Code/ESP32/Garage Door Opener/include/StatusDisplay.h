@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "Config.h"
+
+// Status text and animations on the MAX7219 display, drawn through the layers of displayEngine.
+// Loop task only. Nothing here allocates or blocks: text is taken as C strings, numbers are
+// formatted on the stack and animations are stepped by TIMER_DISPLAY.
+
+// Shows str right-aligned from startSegment on the status layer, prefix fills the digits to its left.
+// The text clears itself after holdMillis; a passkey on screen stays on top until it is cleared.
+void displayString(const char *str, uint8_t startSegment, const char *prefix = "",
+                   unsigned long holdMillis = DISPLAY_CLEAR_MILLIS);
+void displayString(uint32_t numberInt, uint8_t startSegment, const char *prefix = "");
+
+// Clears the status layer (text or animation)
+void displayClear();
+
+// Puts a pairing passkey on the passkey layer, above everything else, until displayPasskeyClear()
+void displayPasskey(uint32_t passkey);
+void displayPasskeyClear();
+
+// One sweep across the segment lines while the relay is actuated
+void knightRiderStart();
+bool knightRiderActive();
+
+// Repeats the sweep with a short pause in between for duration milliseconds
+void displayPattern(uint32_t duration);
+
+// Heartbeat on the idle layer while no phone is connected; status text and the passkey cover it
+void displayIdleStart();
+void displayIdleStop();
+
+void displayTick(); // TIMER_DISPLAY handler
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "esp_timer.h"
+
+// Latency timestamps in microseconds. esp_timer is shared by both cores, unlike the per-core
+// CCOUNT cycle counter, so spans that start on the BLE task and end on another task stay valid.
+inline uint32_t latencyTimestamp() {
+    return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+constexpr uint8_t HISTOGRAM_BUCKETS = 24; // Bucket n counts samples in [2^(n-1), 2^n) us; the last one is open ended
+
+/**
+ * Fixed-size log2 histogram with min/max/count.
+ * Each histogram has a single writer task; readers may see a sample half applied,
+ * which is acceptable for diagnostics.
+ */
+struct Log2Histogram {
+    uint32_t count = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    uint32_t buckets[HISTOGRAM_BUCKETS] = {};
+
+    void record(uint32_t micros);
+};
+
+enum Histogram : uint8_t {
+    HIST_WRITE_TO_RELAY,     // onWrite -> relay energized (loop task)
+    HIST_CONNECT_TO_ENCRYPT, // onConnect -> esp_ble_set_encryption() issued (BLE task)
+    HIST_ENCRYPT_TO_AUTH,    // encryption requested -> onAuthenticationComplete (BLE task)
+    HIST_CONN_EVENT_PERIOD,  // Negotiated interval * (1 + latency): worst case command delay and radio duty cycle (loop task)
+    HIST_COUNT
+};
+
+enum Counter : uint8_t {
+    COUNTER_REJECTED_CONNECTIONS,
+    COUNTER_REJECTED_SECURITY,    // Security requests and passkey displays refused outside pairing mode
+    COUNTER_DISPLAY_UPDATES,
+    COUNTER_COALESCED_TRIGGERS,   // Triggers folded into the relay pulse already running
+    COUNTER_COMMANDS_DROPPED,     // Commands refused because their connection's queue lane was full
+    COUNTER_CONN_PARAM_UPDATES,   // Connection parameter changes the central agreed to
+    COUNTER_CONN_PARAM_FAILURES,  // Updates the central refused or that timed out
+    COUNTER_DISPLAY_FLUSH_MAX_US, // Gauges below are refreshed by the owner before export
+    COUNTER_BLE_EVENTS,
+    COUNTER_BLE_EVENTS_DROPPED,
+    COUNTER_BLE_QUEUE_HIGH_WATER,
+    COUNTER_BOOT_SETUP_US,        // BootTimeline stamps, one per BootPhase in order
+    COUNTER_BOOT_BLE_READY_US,
+    COUNTER_BOOT_GATT_READY_US,
+    COUNTER_BOOT_ADVERTISING_US,
+    COUNTER_BOOT_DEFERRED_DONE_US,
+    COUNTER_HEAP_FREE,            // Internal 8-bit heap, from heap_caps_get_info()
+    COUNTER_HEAP_LARGEST_BLOCK,   // Largest allocatable block: drops as the heap fragments
+    COUNTER_HEAP_MIN_FREE,        // Low water mark since boot
+    COUNTER_HEAP_ALLOCATED_BLOCKS,
+    COUNTER_HEAP_FREE_BLOCKS,     // Free fragments
+    COUNTER_HEAP_BOOT_BLOCKS,     // Allocated blocks once boot finished; a soak run should stay at it
+    COUNTER_LOG_WRITTEN,          // Log records queued for the log task
+    COUNTER_LOG_DROPPED,          // Log records lost to a full ring
+    COUNTER_AUDIT_RECORDS,        // Door events kept in the audit partition
+    COUNTER_AUDIT_FLASH_WRITES,   // One per batch, or two when it crosses a sector
+    COUNTER_AUDIT_SECTOR_ERASES,
+    COUNTER_REGISTRY_WRITES,      // NVS writes of the device registry blob
+    COUNTER_DOOR_NOTIFICATIONS,   // Door state pushes (one per burst of transitions)
+    COUNTER_DOOR_COALESCED,       // Transitions folded into a pending push, or undone before it went out
+    COUNTER_BLE_BACKEND,          // BleBackendKind the image was built with; this and the next three compare backends
+    COUNTER_BLE_INIT_US,          // ble::init(): controller and host stack start
+    COUNTER_BLE_HEAP_BYTES,       // Heap taken by the host stack, GATT table and callbacks during setup()
+    COUNTER_FLASH_IMAGE_BYTES,    // Size of the running app image
+    COUNTER_COUNT
+};
+
+constexpr uint8_t TELEMETRY_FORMAT_VERSION = 1;
+
+/**
+ * Hot-path latency histograms and event counters.
+ *
+ * Binary export layout (little endian):
+ *   [version u8][histogram count u8][bucket count u8][counter count u8]
+ *   counters: u32 x counter count
+ *   per histogram: count u32, min u32, max u32, buckets u16 x bucket count (saturating)
+ */
+class Telemetry {
+public:
+    void count(Counter counter) { counters[counter].fetch_add(1, std::memory_order_relaxed); }
+    void set(Counter counter, uint32_t value) { counters[counter].store(value, std::memory_order_relaxed); }
+    uint32_t get(Counter counter) const { return counters[counter].load(std::memory_order_relaxed); }
+
+    void record(Histogram histogram, uint32_t micros) { histograms[histogram].record(micros); }
+    const Log2Histogram &histogram(Histogram histogram) const { return histograms[histogram]; }
+
+    static constexpr size_t serializedSize() {
+        return 4 + COUNTER_COUNT * 4 + HIST_COUNT * (12 + HISTOGRAM_BUCKETS * 2);
+    }
+
+    // @return bytes written, 0 if capacity is too small
+    size_t serialize(uint8_t *out, size_t capacity) const;
+
+    // Human readable dump, e.g. to Serial
+    void dump(Print &out) const;
+
+private:
+    Log2Histogram histograms[HIST_COUNT];
+    std::atomic<uint32_t> counters[COUNTER_COUNT] = {};
+};
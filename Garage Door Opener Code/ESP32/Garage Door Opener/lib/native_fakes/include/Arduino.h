@@ -0,0 +1,130 @@
+#pragma once
+
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+// Host stand-in for the Arduino-ESP32 core. Time comes from the virtual clock in FakeHarness.h,
+// pins are plain levels, and Serial output is captured instead of printed.
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+
+// Sketch entry points, provided by src/main.cpp
+void setup();
+void loop();
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+class String {
+public:
+    String(const char *text = "") : value(text ? text : "") {}
+    String(const std::string &text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    explicit String(int number) : value(std::to_string(number)) {}
+    explicit String(unsigned int number) : value(std::to_string(number)) {}
+    explicit String(long number) : value(std::to_string(number)) {}
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+
+    size_t length() const { return value.size(); }
+    char charAt(size_t index) const { return index < value.size() ? value[index] : 0; }
+    const char *c_str() const { return value.c_str(); }
+    bool equals(const String &other) const { return value == other.value; }
+
+    String &operator+=(const String &other) { value += other.value; return *this; }
+    String &operator+=(const char *other) { value += other; return *this; }
+    String &operator+=(char c) { value += c; return *this; }
+    friend String operator+(String lhs, const String &rhs) { return lhs += rhs; }
+    friend bool operator==(const String &lhs, const String &rhs) { return lhs.value == rhs.value; }
+    char operator[](size_t index) const { return charAt(index); }
+
+private:
+    std::string value;
+};
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t write(const char *text) { return text ? write(reinterpret_cast<const uint8_t *>(text), strlen(text)) : 0; }
+    size_t print(const char *text) { return write(text); }
+    size_t print(const String &text) { return write(text.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int number) { return printf("%d", number); }
+    size_t print(unsigned int number) { return printf("%u", number); }
+    size_t print(long number) { return printf("%ld", number); }
+    size_t print(unsigned long number) { return printf("%lu", number); }
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T &value) { return print(value) + println(); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+    using Print::write;
+
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available();
+    int read();
+    int peek();
+    void flush() {}
+    void onReceive(void (*callback)());
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    void restart();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getSketchSize() { return 1024 * 1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+};
+
+extern EspClass ESP;
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "BLEDevice.h"
+
+// Client Characteristic Configuration Descriptor
+class BLE2902 : public BLEDescriptor {
+public:
+    BLE2902() : BLEDescriptor("2902") {}
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "esp_gap_ble_api.h"
+#include "esp_gatts_api.h"
+
+// Bluedroid BLE classes as used by the firmware. Nothing goes on air: the fake server keeps the
+// registered callbacks so tests can drive them (see FakeHarness.h) and records what the firmware
+// sends back.
+
+class BLEServer;
+class BLECharacteristic;
+
+class BLEServerCallbacks {
+public:
+    virtual ~BLEServerCallbacks() = default;
+    virtual void onConnect(BLEServer *pServer) { (void)pServer; }
+    virtual void onConnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param) { (void)param; onConnect(pServer); }
+    virtual void onDisconnect(BLEServer *pServer) { (void)pServer; }
+    virtual void onDisconnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param) { (void)param; onDisconnect(pServer); }
+};
+
+class BLESecurityCallbacks {
+public:
+    virtual ~BLESecurityCallbacks() = default;
+    virtual uint32_t onPassKeyRequest() = 0;
+    virtual void onPassKeyNotify(uint32_t pass_key) = 0;
+    virtual bool onSecurityRequest() = 0;
+    virtual void onAuthenticationComplete(esp_ble_auth_cmpl_t auth_cmpl) = 0;
+    virtual bool onConfirmPIN(uint32_t pin) = 0;
+};
+
+class BLECharacteristicCallbacks {
+public:
+    virtual ~BLECharacteristicCallbacks() = default;
+    virtual void onRead(BLECharacteristic *pCharacteristic) { (void)pCharacteristic; }
+    virtual void onWrite(BLECharacteristic *pCharacteristic) { (void)pCharacteristic; }
+    virtual void onWrite(BLECharacteristic *pCharacteristic, esp_ble_gatts_cb_param_t *param) {
+        (void)param;
+        onWrite(pCharacteristic);
+    }
+};
+
+class BLEDescriptor {
+public:
+    explicit BLEDescriptor(const char *uuid);
+    virtual ~BLEDescriptor() = default;
+
+    uint16_t getHandle() const { return handle; }
+    const std::string &getUUIDString() const { return uuid; }
+
+private:
+    std::string uuid;
+    uint16_t handle;
+};
+
+class BLECharacteristic {
+public:
+    static const uint32_t PROPERTY_READ = 1 << 0;
+    static const uint32_t PROPERTY_WRITE = 1 << 1;
+    static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+    static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+    static const uint32_t PROPERTY_INDICATE = 1 << 4;
+    static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+    BLECharacteristic(const char *uuid, uint32_t properties);
+    ~BLECharacteristic();
+
+    void setCallbacks(BLECharacteristicCallbacks *callbacks) { this->callbacks = callbacks; }
+    BLECharacteristicCallbacks *getCallbacks() const { return callbacks; }
+
+    void setValue(uint8_t *data, size_t length) { value.assign(reinterpret_cast<const char *>(data), length); }
+    void setValue(const std::string &text) { value = text; }
+    void setValue(const char *text) { value = text; }
+    std::string getValue() const { return value; }
+    uint8_t *getData() { return reinterpret_cast<uint8_t *>(&value[0]); }
+    size_t getLength() const { return value.size(); }
+
+    void notify(bool isNotification = true);
+    void indicate() { notify(false); }
+
+    void addDescriptor(BLEDescriptor *descriptor) { descriptors.push_back(descriptor); }
+    BLEDescriptor *getDescriptorByUUID(const char *uuid) const;
+
+    // Recorded only; fake::read() does not check the link's security
+    void setAccessPermissions(esp_gatt_perm_t perm) { permissions = perm; }
+    esp_gatt_perm_t getAccessPermissions() const { return permissions; }
+
+    uint16_t getHandle() const { return handle; }
+    const std::string &getUUIDString() const { return uuid; }
+    uint32_t getProperties() const { return properties; }
+
+private:
+    std::string uuid;
+    uint32_t properties;
+    esp_gatt_perm_t permissions = ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE;
+    uint16_t handle;
+    std::string value;
+    BLECharacteristicCallbacks *callbacks = nullptr;
+    std::vector<BLEDescriptor *> descriptors;
+};
+
+class BLEService {
+public:
+    explicit BLEService(const char *uuid) : uuid(uuid) {}
+    ~BLEService();
+
+    BLECharacteristic *createCharacteristic(const char *uuid, uint32_t properties);
+    BLECharacteristic *getCharacteristic(const char *uuid);
+    void start() { started = true; }
+
+    std::string uuid;
+    bool started = false;
+    std::vector<BLECharacteristic *> characteristics;
+};
+
+class BLEAdvertising {
+public:
+    void addServiceUUID(const char *uuid) { serviceUuids.push_back(uuid); }
+    void setMinPreferred(uint16_t interval) { minPreferred = interval; }
+    void setMaxPreferred(uint16_t interval) { maxPreferred = interval; }
+    void setScanResponse(bool enabled) { scanResponse = enabled; }
+    void setScanFilter(bool scanRequestWhitelistOnly, bool connectWhitelistOnly) {
+        scanFilter = scanRequestWhitelistOnly;
+        connectFilter = connectWhitelistOnly;
+    }
+    void start();
+    void stop();
+
+    std::vector<std::string> serviceUuids;
+    uint16_t minPreferred = 0;
+    uint16_t maxPreferred = 0;
+    bool scanResponse = true;
+    bool scanFilter = false;
+    bool connectFilter = false;
+    bool active = false;
+    uint32_t startCount = 0;
+};
+
+class BLEServer {
+public:
+    ~BLEServer();
+
+    BLEService *createService(const char *uuid);
+    BLEService *getServiceByUUID(const char *uuid);
+    // Fake only, search every service
+    BLECharacteristic *findCharacteristic(const char *uuid);
+    BLECharacteristic *findCharacteristic(uint16_t handle);
+    void setCallbacks(BLEServerCallbacks *callbacks) { this->callbacks = callbacks; }
+    BLEServerCallbacks *getCallbacks() const { return callbacks; }
+    BLEAdvertising *getAdvertising() { return &advertising; }
+    void startAdvertising() { advertising.start(); }
+
+    void disconnect(uint16_t connId);
+    uint16_t getConnId() const { return connId; }
+    uint32_t getConnectedCount() const { return connectedCount; }
+    uint16_t getPeerMTU(uint16_t connId) const;
+    esp_gatt_if_t getGattsIf() const { return 3; }
+
+    // Maintained by fake::connect()/fake::disconnect()
+    uint16_t connId = 0;
+    uint32_t connectedCount = 0;
+    std::map<uint16_t, uint16_t> peerMtu; // fake::setPeerMtu(), 23 when unset
+
+private:
+    BLEServerCallbacks *callbacks = nullptr;
+    BLEAdvertising advertising;
+    std::vector<BLEService *> services;
+};
+
+class BLESecurity {
+public:
+    void setAuthenticationMode(esp_ble_auth_req_t mode) { authMode = mode; }
+    void setCapability(esp_ble_io_cap_t capability) { ioCapability = capability; }
+    void setInitEncryptionKey(uint8_t keys) { initKeys = keys; }
+    void setRespEncryptionKey(uint8_t keys) { respKeys = keys; }
+
+    esp_ble_auth_req_t authMode = 0;
+    esp_ble_io_cap_t ioCapability = ESP_IO_CAP_NONE;
+    uint8_t initKeys = 0;
+    uint8_t respKeys = 0;
+};
+
+typedef void (*gap_event_handler)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param);
+typedef void (*gatts_event_handler)(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
+
+class BLEDevice {
+public:
+    static void init(const char *deviceName);
+    static BLEServer *createServer();
+    static void setSecurityCallbacks(BLESecurityCallbacks *callbacks);
+    static void setMTU(uint16_t mtu);
+    static void setCustomGapHandler(gap_event_handler handler);
+    static void setCustomGattsHandler(gatts_event_handler handler);
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <BLEDevice.h>
+
+/**
+ * Test-side controls for the native fakes: a virtual clock that fires esp_timer callbacks,
+ * pin levels that raise attached interrupts, an injectable bond table, and drivers for the
+ * BLE callbacks the firmware registered. Everything is deterministic and single threaded;
+ * "BLE task", "esp_timer task" and ISR code simply run inline on the caller.
+ */
+namespace fake {
+
+// Drops all fake state: clock back to zero, pins low, no timers, no BLE objects, empty NVS,
+// empty bond table, cleared Serial capture. Objects the firmware created are deleted, so
+// setup() must run again afterwards.
+void reset();
+
+// --- Virtual clock ---
+uint64_t nowMicros();
+void advanceMicros(uint64_t micros); // Fires due esp_timer callbacks in deadline order
+void advanceMillis(uint32_t millis);
+
+// --- GPIO ---
+// Changes an input level; an attached interrupt fires if the edge matches its mode
+void setPin(uint8_t pin, int level);
+int pinLevel(uint8_t pin);
+uint32_t pinWriteCount(uint8_t pin);
+// Output pulses: LOW to HIGH writes, and the total time spent HIGH by pulses that ended
+uint32_t pinRisingWrites(uint8_t pin);
+uint64_t pinHighMicros(uint8_t pin);
+
+// --- Tasks ---
+uint32_t pendingNotifications();
+
+// --- Serial ---
+const std::string &serialOutput();
+void clearSerialOutput();
+void serialInput(const std::string &text); // Queues input and calls the onReceive callback
+
+// --- ESP ---
+uint32_t restartCount();
+
+// --- SPI ---
+const std::vector<uint16_t> &spiFrames();
+uint32_t spiTransactions();
+void clearSpi();
+
+// --- Flash ---
+// The single data partition behind esp_partition_*: label "audit", subtype 0x40, 512 KB
+std::vector<uint8_t> &partitionData(); // Writable, e.g. to corrupt a record
+uint32_t partitionWrites();
+uint32_t partitionErases(uint32_t sector);
+// The next write stops after this many bytes, like a power cut mid-write; 0 turns it off
+void cutPowerAfter(size_t bytes);
+
+// --- Bond table ---
+void addBond(const uint8_t address[ESP_BD_ADDR_LEN]);
+void clearBonds();
+bool bonded(const uint8_t address[ESP_BD_ADDR_LEN]); // Still in the table, e.g. after esp_ble_remove_bond_device()
+uint32_t encryptionRequests();
+
+// --- Controller whitelist ---
+const std::vector<std::string> &whitelist(); // Raw 6-byte addresses, in insertion order
+void setWhitelistCapacity(uint16_t capacity); // Defaults to 12, like the ESP32 controller
+
+// --- BLE ---
+constexpr uint16_t ALL_CONNECTIONS = 0xFFFF; // Notification::connId of BLECharacteristic::notify()
+
+struct Notification {
+    std::string uuid;
+    uint16_t connId;
+    std::string value;
+};
+
+BLEServer *server();
+BLEAdvertising *advertising();
+BLECharacteristic *characteristic(const char *uuid);
+const std::vector<Notification> &notifications();
+void clearNotifications();
+const std::vector<uint16_t> &disconnectRequests();
+
+// MTU the central negotiated on a connection; 23 until set
+void setPeerMtu(uint16_t connId, uint16_t mtu);
+
+// Parameter requests made with esp_ble_gap_update_conn_params(), oldest first
+const std::vector<esp_ble_conn_update_params_t> &connParamRequests();
+void clearConnParamRequests();
+
+// Drivers for the registered callbacks; each runs on the caller like the Bluedroid task would.
+// connect() plays the controller too: with whitelist-only advertising running, an address
+// outside the whitelist is ignored and false returned.
+bool connect(const uint8_t address[ESP_BD_ADDR_LEN], uint16_t connId = 0);
+void disconnect(const uint8_t address[ESP_BD_ADDR_LEN], uint16_t connId = 0);
+void write(const char *uuid, const uint8_t *data, size_t length,
+           const uint8_t address[ESP_BD_ADDR_LEN], uint16_t connId = 0);
+void write(const char *uuid, const char *text, const uint8_t address[ESP_BD_ADDR_LEN], uint16_t connId = 0);
+std::string read(const char *uuid);
+// Writes the characteristic's CCCD (its BLE2902) through the custom GATTS handler
+void subscribe(const char *uuid, bool notifications = true, uint16_t connId = 0);
+void passKeyNotify(uint32_t passkey);
+bool securityRequest();
+void authenticationComplete(const uint8_t address[ESP_BD_ADDR_LEN], bool success, uint8_t failReason = 0);
+// ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT to the custom GAP handler
+void connParamsUpdated(const uint8_t address[ESP_BD_ADDR_LEN], uint16_t interval, uint16_t latency, uint16_t timeout,
+                       bool success = true);
+
+} // namespace fake
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "esp_gap_ble_api.h"
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// The GAP security, whitelist and connection parameter calls the firmware makes. The bond table is injected with
+// fake::addBond(); the whitelist is read back with fake::whitelist().
+
+#define ESP_BD_ADDR_LEN 6
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+    BLE_ADDR_TYPE_PUBLIC = 0x00,
+    BLE_ADDR_TYPE_RANDOM = 0x01,
+} esp_ble_addr_type_t;
+
+typedef enum {
+    BLE_WL_ADDR_TYPE_PUBLIC = 0x00,
+    BLE_WL_ADDR_TYPE_RANDOM = 0x01,
+} esp_ble_wl_addr_type_t;
+
+typedef struct {
+    uint8_t irk[16];
+    esp_ble_addr_type_t addr_type;
+    esp_bd_addr_t static_addr;
+} esp_ble_pid_keys_t;
+
+typedef struct {
+    uint8_t key_mask;
+    esp_ble_pid_keys_t pid_key;
+} esp_ble_bond_key_info_t;
+
+typedef struct {
+    esp_bd_addr_t bd_addr;
+    esp_ble_bond_key_info_t bond_key;
+} esp_ble_bond_dev_t;
+
+typedef struct {
+    esp_bd_addr_t bd_addr;
+    bool key_present;
+    uint8_t key_type;
+    bool success;
+    uint8_t fail_reason;
+    esp_ble_addr_type_t addr_type;
+    uint8_t dev_type;
+    uint8_t auth_mode;
+} esp_ble_auth_cmpl_t;
+
+typedef enum {
+    ESP_BT_STATUS_SUCCESS = 0,
+    ESP_BT_STATUS_FAIL,
+} esp_bt_status_t;
+
+typedef struct {
+    esp_bd_addr_t bda;
+    uint16_t min_int;
+    uint16_t max_int;
+    uint16_t latency;
+    uint16_t timeout;
+} esp_ble_conn_update_params_t;
+
+// Only the events the firmware looks at
+typedef enum {
+    ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT = 20,
+} esp_gap_ble_cb_event_t;
+
+typedef union {
+    struct ble_update_conn_params_evt_param {
+        esp_bt_status_t status;
+        esp_bd_addr_t bda;
+        uint16_t min_int;
+        uint16_t max_int;
+        uint16_t latency;
+        uint16_t conn_int;
+        uint16_t timeout;
+    } update_conn_params;
+} esp_ble_gap_cb_param_t;
+
+typedef enum {
+    ESP_BLE_SEC_ENCRYPT = 1,
+    ESP_BLE_SEC_ENCRYPT_NO_MITM,
+    ESP_BLE_SEC_ENCRYPT_MITM,
+} esp_ble_sec_act_t;
+
+typedef uint8_t esp_ble_auth_req_t;
+typedef uint8_t esp_ble_io_cap_t;
+
+#define ESP_LE_AUTH_NO_BOND 0x00
+#define ESP_LE_AUTH_BOND 0x01
+#define ESP_LE_AUTH_REQ_MITM (1 << 2)
+#define ESP_LE_AUTH_REQ_SC_ONLY (1 << 3)
+#define ESP_LE_AUTH_REQ_SC_BOND (ESP_LE_AUTH_BOND | ESP_LE_AUTH_REQ_SC_ONLY)
+#define ESP_LE_AUTH_REQ_SC_MITM (ESP_LE_AUTH_REQ_MITM | ESP_LE_AUTH_REQ_SC_ONLY)
+#define ESP_LE_AUTH_REQ_SC_MITM_BOND (ESP_LE_AUTH_REQ_MITM | ESP_LE_AUTH_REQ_SC_ONLY | ESP_LE_AUTH_BOND)
+
+#define ESP_IO_CAP_OUT 0
+#define ESP_IO_CAP_IO 1
+#define ESP_IO_CAP_IN 2
+#define ESP_IO_CAP_NONE 3
+
+#define ESP_BLE_ENC_KEY_MASK (1 << 0)
+#define ESP_BLE_ID_KEY_MASK (1 << 1)
+
+// esp_ble_bond_key_info_t::key_mask bits
+#define ESP_LE_KEY_PENC (1 << 0)
+#define ESP_LE_KEY_PID (1 << 1)
+
+int esp_ble_get_bond_device_num();
+esp_err_t esp_ble_get_bond_device_list(int *dev_num, esp_ble_bond_dev_t *dev_list);
+esp_err_t esp_ble_remove_bond_device(esp_bd_addr_t bd_addr);
+esp_err_t esp_ble_set_encryption(esp_bd_addr_t bd_addr, esp_ble_sec_act_t sec_act);
+
+esp_err_t esp_ble_gap_update_whitelist(bool add_remove, esp_bd_addr_t remote_bda, esp_ble_wl_addr_type_t wl_addr_type);
+esp_err_t esp_ble_gap_clear_whitelist();
+esp_err_t esp_ble_gap_get_whitelist_size(uint16_t *length);
+
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+typedef void (*TaskFunction_t)(void *);
+
+// Accepted but never run: there is only the one task. Tests call the task's work directly.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreId);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
+
+// Returns at once if a notification is pending. Otherwise the virtual clock runs forward until
+// an esp_timer callback notifies the task or the timeout passes; portMAX_DELAY returns 0 at once
+// instead of blocking forever.
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+
+void vTaskDelay(TickType_t ticks);
@@ -0,0 +1,255 @@
+#include <Arduino.h>
+#include <FakeHarness.h>
+
+#include <deque>
+
+#include "FakeInternal.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+constexpr uint8_t PIN_COUNT = 40;
+constexpr size_t SERIAL_CAPTURE_LIMIT = 1 << 20; // Oldest output is dropped beyond this
+
+struct PinState {
+    int level;
+    uint32_t writes;
+    uint32_t risingWrites; // LOW to HIGH by digitalWrite()
+    uint64_t highSince;
+    uint64_t highMicros;   // Time held HIGH by digitalWrite(), closed pulses only
+    void (*handler)(void *);
+    void *arg;
+    int mode;
+};
+
+PinState pins[PIN_COUNT];
+
+std::string serialCapture;
+std::deque<char> serialRx;
+void (*serialReceive)() = nullptr;
+
+uint32_t restarts = 0;
+
+void callPlainHandler(void *arg) {
+    reinterpret_cast<void (*)()>(arg)();
+}
+} // namespace
+
+namespace fake {
+
+void setPin(const uint8_t pin, const int level) {
+    if (pin >= PIN_COUNT) return;
+    PinState &state = pins[pin];
+    const int previous = state.level;
+    state.level = level ? HIGH : LOW;
+    if (!state.handler || previous == state.level) return;
+
+    const bool rising = state.level == HIGH;
+    if (state.mode == CHANGE || (state.mode == RISING && rising) || (state.mode == FALLING && !rising)) {
+        state.handler(state.arg);
+    }
+}
+
+int pinLevel(const uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].level : LOW;
+}
+
+uint32_t pinWriteCount(const uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].writes : 0;
+}
+
+uint32_t pinRisingWrites(const uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].risingWrites : 0;
+}
+
+uint64_t pinHighMicros(const uint8_t pin) {
+    return pin < PIN_COUNT ? pins[pin].highMicros : 0;
+}
+
+const std::string &serialOutput() {
+    return serialCapture;
+}
+
+void clearSerialOutput() {
+    serialCapture.clear();
+}
+
+void serialInput(const std::string &text) {
+    serialRx.insert(serialRx.end(), text.begin(), text.end());
+    if (serialReceive) serialReceive();
+}
+
+uint32_t restartCount() {
+    return restarts;
+}
+
+namespace internal {
+void resetGpio() {
+    for (PinState &state : pins) state = PinState{LOW, 0, 0, 0, 0, nullptr, nullptr, 0};
+}
+
+void resetSerial() {
+    serialCapture.clear();
+    serialRx.clear();
+    serialReceive = nullptr;
+    restarts = 0;
+}
+} // namespace internal
+
+} // namespace fake
+
+// --- GPIO ---
+
+void pinMode(const uint8_t pin, const uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(const uint8_t pin, const uint8_t value) {
+    if (pin >= PIN_COUNT) return;
+    PinState &state = pins[pin];
+    const int level = value ? HIGH : LOW;
+    if (level == HIGH && state.level == LOW) {
+        state.risingWrites++;
+        state.highSince = fake::nowMicros();
+    } else if (level == LOW && state.level == HIGH) {
+        state.highMicros += fake::nowMicros() - state.highSince;
+    }
+    state.level = level;
+    state.writes++;
+}
+
+int digitalRead(const uint8_t pin) {
+    return fake::pinLevel(pin);
+}
+
+void attachInterrupt(const uint8_t pin, void (*handler)(), const int mode) {
+    attachInterruptArg(pin, callPlainHandler, reinterpret_cast<void *>(handler), mode);
+}
+
+void attachInterruptArg(const uint8_t pin, void (*handler)(void *), void *arg, const int mode) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = handler;
+    pins[pin].arg = arg;
+    pins[pin].mode = mode;
+}
+
+void detachInterrupt(const uint8_t pin) {
+    if (pin >= PIN_COUNT) return;
+    pins[pin].handler = nullptr;
+}
+
+// --- Print / Serial ---
+
+size_t Print::write(const uint8_t *buffer, const size_t size) {
+    size_t written = 0;
+    for (size_t i = 0; i < size; i++) written += write(buffer[i]);
+    return written;
+}
+
+size_t Print::printf(const char *format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    if (static_cast<size_t>(length) < sizeof(small)) {
+        return write(reinterpret_cast<const uint8_t *>(small), length);
+    }
+
+    std::string large(length + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&large[0], large.size(), format, args);
+    va_end(args);
+    return write(reinterpret_cast<const uint8_t *>(large.data()), length);
+}
+
+size_t HardwareSerial::write(const uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, const size_t size) {
+    if (serialCapture.size() + size > SERIAL_CAPTURE_LIMIT) {
+        serialCapture.erase(0, serialCapture.size() / 2);
+    }
+    serialCapture.append(reinterpret_cast<const char *>(buffer), size);
+    return size;
+}
+
+int HardwareSerial::available() {
+    return static_cast<int>(serialRx.size());
+}
+
+int HardwareSerial::read() {
+    if (serialRx.empty()) return -1;
+    const char c = serialRx.front();
+    serialRx.pop_front();
+    return static_cast<uint8_t>(c);
+}
+
+int HardwareSerial::peek() {
+    return serialRx.empty() ? -1 : static_cast<uint8_t>(serialRx.front());
+}
+
+void HardwareSerial::onReceive(void (*callback)()) {
+    serialReceive = callback;
+}
+
+// --- ESP / heap ---
+
+void EspClass::restart() {
+    restarts++; // The caller keeps running; tests check the count instead
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return 200 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return 180 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return 110 * 1024;
+}
+
+static size_t liveHeapBlocks = 0;
+
+void *heap_caps_malloc(const size_t size, const uint32_t caps) {
+    (void)caps;
+    void *ptr = malloc(size);
+    if (ptr) liveHeapBlocks++;
+    return ptr;
+}
+
+void heap_caps_free(void *ptr) {
+    if (ptr) liveHeapBlocks--;
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(const uint32_t caps) {
+    (void)caps;
+    return ESP.getFreeHeap();
+}
+
+size_t heap_caps_get_largest_free_block(const uint32_t caps) {
+    (void)caps;
+    return ESP.getMaxAllocHeap();
+}
+
+size_t heap_caps_get_minimum_free_size(const uint32_t caps) {
+    (void)caps;
+    return ESP.getMinFreeHeap();
+}
+
+void heap_caps_get_info(multi_heap_info_t *info, const uint32_t caps) {
+    *info = {};
+    info->total_free_bytes = heap_caps_get_free_size(caps);
+    info->largest_free_block = heap_caps_get_largest_free_block(caps);
+    info->minimum_free_bytes = heap_caps_get_minimum_free_size(caps);
+    info->allocated_blocks = liveHeapBlocks;
+    info->free_blocks = 1;
+    info->total_blocks = liveHeapBlocks + 1;
+}
@@ -0,0 +1,416 @@
+#include <BLEDevice.h>
+#include <FakeHarness.h>
+
+#include <string.h>
+
+#include "FakeInternal.h"
+
+namespace {
+BLEServer *activeServer = nullptr;
+BLESecurityCallbacks *securityCallbacks = nullptr;
+gap_event_handler customGapHandler = nullptr;
+gatts_event_handler customGattsHandler = nullptr;
+std::vector<esp_ble_conn_update_params_t> connParamUpdates;
+std::vector<fake::Notification> sentNotifications;
+std::vector<uint16_t> requestedDisconnects;
+std::vector<esp_ble_bond_dev_t> bonds;
+uint32_t encryptions = 0;
+std::vector<std::string> whitelistEntries;
+constexpr uint16_t DEFAULT_WHITELIST_CAPACITY = 12;
+uint16_t whitelistCapacity = DEFAULT_WHITELIST_CAPACITY;
+
+std::string addressKey(const uint8_t address[ESP_BD_ADDR_LEN]) {
+    return std::string(reinterpret_cast<const char *>(address), ESP_BD_ADDR_LEN);
+}
+
+bool whitelisted(const uint8_t address[ESP_BD_ADDR_LEN]) {
+    for (const std::string &entry : whitelistEntries) {
+        if (entry == addressKey(address)) return true;
+    }
+    return false;
+}
+uint16_t nextHandle = 0x2A;
+} // namespace
+
+namespace fake {
+
+BLEServer *server() {
+    return activeServer;
+}
+
+BLEAdvertising *advertising() {
+    return activeServer ? activeServer->getAdvertising() : nullptr;
+}
+
+BLECharacteristic *characteristic(const char *uuid) {
+    if (!activeServer) return nullptr;
+    return activeServer->findCharacteristic(uuid);
+}
+
+const std::vector<Notification> &notifications() {
+    return sentNotifications;
+}
+
+void clearNotifications() {
+    sentNotifications.clear();
+}
+
+const std::vector<uint16_t> &disconnectRequests() {
+    return requestedDisconnects;
+}
+
+void addBond(const uint8_t address[ESP_BD_ADDR_LEN]) {
+    esp_ble_bond_dev_t bond{};
+    memcpy(bond.bd_addr, address, ESP_BD_ADDR_LEN);
+    bonds.push_back(bond);
+}
+
+void clearBonds() {
+    bonds.clear();
+}
+
+bool bonded(const uint8_t address[ESP_BD_ADDR_LEN]) {
+    for (const esp_ble_bond_dev_t &bond : bonds) {
+        if (memcmp(bond.bd_addr, address, ESP_BD_ADDR_LEN) == 0) return true;
+    }
+    return false;
+}
+
+uint32_t encryptionRequests() {
+    return encryptions;
+}
+
+const std::vector<std::string> &whitelist() {
+    return whitelistEntries;
+}
+
+void setWhitelistCapacity(const uint16_t capacity) {
+    whitelistCapacity = capacity;
+}
+
+const std::vector<esp_ble_conn_update_params_t> &connParamRequests() {
+    return connParamUpdates;
+}
+
+void clearConnParamRequests() {
+    connParamUpdates.clear();
+}
+
+void setPeerMtu(const uint16_t connId, const uint16_t mtu) {
+    if (activeServer) activeServer->peerMtu[connId] = mtu;
+}
+
+bool connect(const uint8_t address[ESP_BD_ADDR_LEN], const uint16_t connId) {
+    if (!activeServer) return false;
+    const BLEAdvertising *advertising = activeServer->getAdvertising();
+    if (advertising->active && advertising->connectFilter && !whitelisted(address)) return false;
+    activeServer->connId = connId;
+    activeServer->connectedCount++;
+    activeServer->getAdvertising()->active = false; // The stack stops advertising on connect
+    if (!activeServer->getCallbacks()) return true;
+
+    esp_ble_gatts_cb_param_t param{};
+    param.connect.conn_id = connId;
+    memcpy(param.connect.remote_bda, address, ESP_BD_ADDR_LEN);
+    activeServer->getCallbacks()->onConnect(activeServer, &param);
+    return true;
+}
+
+void disconnect(const uint8_t address[ESP_BD_ADDR_LEN], const uint16_t connId) {
+    if (!activeServer) return;
+    if (activeServer->connectedCount > 0) activeServer->connectedCount--;
+    if (!activeServer->getCallbacks()) return;
+
+    esp_ble_gatts_cb_param_t param{};
+    param.disconnect.conn_id = connId;
+    memcpy(param.disconnect.remote_bda, address, ESP_BD_ADDR_LEN);
+    activeServer->getCallbacks()->onDisconnect(activeServer, &param);
+}
+
+void write(const char *uuid, const uint8_t *data, const size_t length,
+           const uint8_t address[ESP_BD_ADDR_LEN], const uint16_t connId) {
+    BLECharacteristic *target = characteristic(uuid);
+    if (!target) return;
+    target->setValue(const_cast<uint8_t *>(data), length);
+    if (!target->getCallbacks()) return;
+
+    esp_ble_gatts_cb_param_t param{};
+    param.write.conn_id = connId;
+    memcpy(param.write.bda, address, ESP_BD_ADDR_LEN);
+    param.write.len = static_cast<uint16_t>(length);
+    param.write.value = target->getData();
+    target->getCallbacks()->onWrite(target, &param);
+}
+
+void write(const char *uuid, const char *text, const uint8_t address[ESP_BD_ADDR_LEN], const uint16_t connId) {
+    write(uuid, reinterpret_cast<const uint8_t *>(text), strlen(text), address, connId);
+}
+
+std::string read(const char *uuid) {
+    BLECharacteristic *target = characteristic(uuid);
+    if (!target) return {};
+    if (target->getCallbacks()) target->getCallbacks()->onRead(target);
+    return target->getValue();
+}
+
+void subscribe(const char *uuid, const bool notifications, const uint16_t connId) {
+    const BLECharacteristic *target = characteristic(uuid);
+    const BLEDescriptor *cccd = target ? target->getDescriptorByUUID("2902") : nullptr;
+    if (!cccd || !customGattsHandler) return;
+
+    uint8_t value[2] = {static_cast<uint8_t>(notifications ? 0x01 : 0x00), 0x00};
+    esp_ble_gatts_cb_param_t param{};
+    param.write.conn_id = connId;
+    param.write.handle = cccd->getHandle();
+    param.write.len = sizeof(value);
+    param.write.value = value;
+    customGattsHandler(ESP_GATTS_WRITE_EVT, activeServer->getGattsIf(), &param);
+}
+
+void passKeyNotify(const uint32_t passkey) {
+    if (securityCallbacks) securityCallbacks->onPassKeyNotify(passkey);
+}
+
+bool securityRequest() {
+    return securityCallbacks && securityCallbacks->onSecurityRequest();
+}
+
+void authenticationComplete(const uint8_t address[ESP_BD_ADDR_LEN], const bool success, const uint8_t failReason) {
+    if (success) {
+        bool known = false;
+        for (const esp_ble_bond_dev_t &bond : bonds) known |= memcmp(bond.bd_addr, address, ESP_BD_ADDR_LEN) == 0;
+        if (!known) addBond(address); // The stack stores the new bond before reporting it
+    }
+    if (!securityCallbacks) return;
+    esp_ble_auth_cmpl_t result{};
+    memcpy(result.bd_addr, address, ESP_BD_ADDR_LEN);
+    result.success = success;
+    result.fail_reason = failReason;
+    securityCallbacks->onAuthenticationComplete(result);
+}
+
+void connParamsUpdated(const uint8_t address[ESP_BD_ADDR_LEN], const uint16_t interval, const uint16_t latency,
+                       const uint16_t timeout, const bool success) {
+    if (!customGapHandler) return;
+    esp_ble_gap_cb_param_t param{};
+    auto &update = param.update_conn_params;
+    update.status = success ? ESP_BT_STATUS_SUCCESS : ESP_BT_STATUS_FAIL;
+    memcpy(update.bda, address, ESP_BD_ADDR_LEN);
+    update.min_int = interval;
+    update.max_int = interval;
+    update.conn_int = interval;
+    update.latency = latency;
+    update.timeout = timeout;
+    customGapHandler(ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT, &param);
+}
+
+namespace internal {
+void resetBle() {
+    delete activeServer;
+    activeServer = nullptr;
+    securityCallbacks = nullptr; // Owned by the firmware, which never frees them either
+    customGapHandler = nullptr;
+    customGattsHandler = nullptr;
+    connParamUpdates.clear();
+    sentNotifications.clear();
+    requestedDisconnects.clear();
+    bonds.clear();
+    encryptions = 0;
+    whitelistEntries.clear();
+    whitelistCapacity = DEFAULT_WHITELIST_CAPACITY;
+}
+} // namespace internal
+
+} // namespace fake
+
+// --- BLE classes ---
+
+BLEDescriptor::BLEDescriptor(const char *uuid) : uuid(uuid), handle(nextHandle++) {}
+
+BLECharacteristic::BLECharacteristic(const char *uuid, const uint32_t properties)
+    : uuid(uuid), properties(properties), handle(nextHandle++) {}
+
+BLECharacteristic::~BLECharacteristic() {
+    for (BLEDescriptor *descriptor : descriptors) delete descriptor;
+}
+
+BLEDescriptor *BLECharacteristic::getDescriptorByUUID(const char *uuid) const {
+    for (BLEDescriptor *descriptor : descriptors) {
+        if (descriptor->getUUIDString() == uuid) return descriptor;
+    }
+    return nullptr;
+}
+
+void BLECharacteristic::notify(const bool isNotification) {
+    (void)isNotification;
+    sentNotifications.push_back({uuid, fake::ALL_CONNECTIONS, value});
+}
+
+BLEService::~BLEService() {
+    for (BLECharacteristic *characteristic : characteristics) delete characteristic;
+}
+
+BLECharacteristic *BLEService::createCharacteristic(const char *uuid, const uint32_t properties) {
+    auto *characteristic = new BLECharacteristic(uuid, properties);
+    characteristics.push_back(characteristic);
+    return characteristic;
+}
+
+BLECharacteristic *BLEService::getCharacteristic(const char *uuid) {
+    for (BLECharacteristic *characteristic : characteristics) {
+        if (characteristic->getUUIDString() == uuid) return characteristic;
+    }
+    return nullptr;
+}
+
+void BLEAdvertising::start() {
+    active = true;
+    startCount++;
+}
+
+void BLEAdvertising::stop() {
+    active = false;
+}
+
+BLEServer::~BLEServer() {
+    for (BLEService *service : services) delete service;
+}
+
+BLEService *BLEServer::createService(const char *uuid) {
+    auto *service = new BLEService(uuid);
+    services.push_back(service);
+    return service;
+}
+
+BLEService *BLEServer::getServiceByUUID(const char *uuid) {
+    for (BLEService *service : services) {
+        if (service->uuid == uuid) return service;
+    }
+    return nullptr;
+}
+
+BLECharacteristic *BLEServer::findCharacteristic(const char *uuid) {
+    for (BLEService *service : services) {
+        if (BLECharacteristic *characteristic = service->getCharacteristic(uuid)) return characteristic;
+    }
+    return nullptr;
+}
+
+BLECharacteristic *BLEServer::findCharacteristic(const uint16_t handle) {
+    for (BLEService *service : services) {
+        for (BLECharacteristic *characteristic : service->characteristics) {
+            if (characteristic->getHandle() == handle) return characteristic;
+        }
+    }
+    return nullptr;
+}
+
+uint16_t BLEServer::getPeerMTU(const uint16_t connId) const {
+    const auto mtu = peerMtu.find(connId);
+    return mtu == peerMtu.end() ? 23 : mtu->second;
+}
+
+void BLEServer::disconnect(const uint16_t connId) {
+    requestedDisconnects.push_back(connId);
+}
+
+void BLEDevice::init(const char *deviceName) {
+    (void)deviceName;
+}
+
+BLEServer *BLEDevice::createServer() {
+    delete activeServer;
+    activeServer = new BLEServer();
+    return activeServer;
+}
+
+void BLEDevice::setSecurityCallbacks(BLESecurityCallbacks *callbacks) {
+    securityCallbacks = callbacks;
+}
+
+void BLEDevice::setMTU(const uint16_t mtu) {
+    (void)mtu;
+}
+
+void BLEDevice::setCustomGapHandler(const gap_event_handler handler) {
+    customGapHandler = handler;
+}
+
+void BLEDevice::setCustomGattsHandler(const gatts_event_handler handler) {
+    customGattsHandler = handler;
+}
+
+// --- GATT / GAP ---
+
+esp_err_t esp_ble_gatts_send_indicate(const esp_gatt_if_t gatts_if, const uint16_t conn_id, const uint16_t attr_handle,
+                                      const uint16_t value_len, uint8_t *value, const bool need_confirm) {
+    (void)gatts_if;
+    (void)need_confirm;
+    if (!activeServer) return ESP_FAIL;
+    const BLECharacteristic *characteristic = activeServer->findCharacteristic(attr_handle);
+    if (!characteristic) return ESP_ERR_INVALID_ARG;
+    sentNotifications.push_back({characteristic->getUUIDString(), conn_id, std::string(reinterpret_cast<const char *>(value), value_len)});
+    return ESP_OK;
+}
+
+
+int esp_ble_get_bond_device_num() {
+    return static_cast<int>(bonds.size());
+}
+
+esp_err_t esp_ble_get_bond_device_list(int *dev_num, esp_ble_bond_dev_t *dev_list) {
+    if (!dev_num || !dev_list) return ESP_ERR_INVALID_ARG;
+    const int count = *dev_num < static_cast<int>(bonds.size()) ? *dev_num : static_cast<int>(bonds.size());
+    for (int i = 0; i < count; i++) dev_list[i] = bonds[i];
+    *dev_num = count;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_remove_bond_device(esp_bd_addr_t bd_addr) {
+    for (auto it = bonds.begin(); it != bonds.end(); ++it) {
+        if (memcmp(it->bd_addr, bd_addr, ESP_BD_ADDR_LEN) == 0) {
+            bonds.erase(it);
+            return ESP_OK;
+        }
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t esp_ble_gap_update_whitelist(const bool add_remove, esp_bd_addr_t remote_bda, const esp_ble_wl_addr_type_t wl_addr_type) {
+    (void)wl_addr_type;
+    if (!remote_bda) return ESP_ERR_INVALID_ARG;
+    const std::string key = addressKey(remote_bda);
+    for (auto it = whitelistEntries.begin(); it != whitelistEntries.end(); ++it) {
+        if (*it != key) continue;
+        if (!add_remove) whitelistEntries.erase(it);
+        return ESP_OK;
+    }
+    if (!add_remove) return ESP_OK;
+    if (whitelistEntries.size() >= whitelistCapacity) return ESP_FAIL;
+    whitelistEntries.push_back(key);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_clear_whitelist() {
+    whitelistEntries.clear();
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_get_whitelist_size(uint16_t *length) {
+    if (!length) return ESP_ERR_INVALID_ARG;
+    *length = whitelistCapacity;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_update_conn_params(esp_ble_conn_update_params_t *params) {
+    if (!params) return ESP_ERR_INVALID_ARG;
+    connParamUpdates.push_back(*params);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_set_encryption(esp_bd_addr_t bd_addr, const esp_ble_sec_act_t sec_act) {
+    (void)bd_addr;
+    (void)sec_act;
+    encryptions++;
+    return ESP_OK;
+}
@@ -0,0 +1,197 @@
+#include <Arduino.h>
+#include <FakeHarness.h>
+
+#include <vector>
+
+#include "FakeInternal.h"
+
+// esp_timer_handle_t points at one of these; handles stay valid until reset()
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    uint64_t deadline;
+    uint64_t period; // 0 for one-shot
+    bool active;
+};
+
+namespace {
+uint64_t clockMicros = 0;
+std::vector<esp_timer *> timers;
+uint32_t taskNotifications = 0;
+
+// The single task every caller runs on
+int loopTaskTag;
+
+esp_timer *nextDueTimer(const uint64_t until) {
+    esp_timer *next = nullptr;
+    for (esp_timer *timer : timers) {
+        if (!timer->active || timer->deadline > until) continue;
+        if (!next || timer->deadline < next->deadline) next = timer;
+    }
+    return next;
+}
+
+// Moves the clock to `until`, stopping at each timer deadline on the way to run its callback.
+// Returns early once a callback has notified the task if stopOnNotify is set.
+void runClockTo(const uint64_t until, const bool stopOnNotify) {
+    while (esp_timer *timer = nextDueTimer(until)) {
+        if (timer->deadline > clockMicros) clockMicros = timer->deadline;
+        if (timer->period) {
+            timer->deadline += timer->period;
+        } else {
+            timer->active = false;
+        }
+        timer->callback(timer->arg);
+        if (stopOnNotify && taskNotifications > 0) return;
+    }
+    if (until > clockMicros) clockMicros = until;
+}
+} // namespace
+
+namespace fake {
+
+uint64_t nowMicros() {
+    return clockMicros;
+}
+
+void advanceMicros(const uint64_t micros) {
+    runClockTo(clockMicros + micros, false);
+}
+
+void advanceMillis(const uint32_t millis) {
+    advanceMicros(static_cast<uint64_t>(millis) * 1000);
+}
+
+uint32_t pendingNotifications() {
+    return taskNotifications;
+}
+
+void reset() {
+    internal::resetClock();
+    internal::resetGpio();
+    internal::resetSerial();
+    internal::resetSpi();
+    internal::resetPreferences();
+    internal::resetPartition();
+    internal::resetBle();
+}
+
+namespace internal {
+void resetClock() {
+    for (esp_timer *timer : timers) delete timer;
+    timers.clear();
+    clockMicros = 0;
+    taskNotifications = 0;
+}
+} // namespace internal
+
+} // namespace fake
+
+unsigned long millis() {
+    return static_cast<unsigned long>(clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(clockMicros);
+}
+
+void delay(const uint32_t ms) {
+    fake::advanceMillis(ms);
+}
+
+void delayMicroseconds(const uint32_t us) {
+    fake::advanceMicros(us);
+}
+
+void vTaskDelay(const TickType_t ticks) {
+    fake::advanceMillis(ticks);
+}
+
+// --- esp_timer ---
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle) {
+    if (!args || !args->callback || !out_handle) return ESP_ERR_INVALID_ARG;
+    auto *timer = new esp_timer{args->callback, args->arg, 0, 0, false};
+    timers.push_back(timer);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, const uint64_t timeout_us) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->deadline = clockMicros + timeout_us;
+    timer->period = 0;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, const uint64_t period_us) {
+    if (!timer || period_us == 0) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->deadline = clockMicros + period_us;
+    timer->period = period_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (!timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (!timer) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    for (auto it = timers.begin(); it != timers.end(); ++it) {
+        if (*it == timer) {
+            timers.erase(it);
+            break;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer && timer->active;
+}
+
+int64_t esp_timer_get_time() {
+    return static_cast<int64_t>(clockMicros);
+}
+
+// --- FreeRTOS task taskNotifications ---
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return &loopTaskTag;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreId) {
+    (void)code, (void)name, (void)stackDepth, (void)parameters, (void)priority, (void)coreId;
+    if (createdTask) *createdTask = nullptr;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    (void)task;
+    taskNotifications++;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clearCountOnExit, const TickType_t ticksToWait) {
+    if (taskNotifications == 0 && ticksToWait != portMAX_DELAY) {
+        runClockTo(clockMicros + static_cast<uint64_t>(ticksToWait) * 1000, true);
+    }
+    const uint32_t taken = taskNotifications;
+    if (taken > 0) taskNotifications = clearCountOnExit ? 0 : taken - 1;
+    return taken;
+}
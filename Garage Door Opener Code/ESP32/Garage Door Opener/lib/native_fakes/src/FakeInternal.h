@@ -0,0 +1,16 @@
+#pragma once
+
+// Per-module reset hooks called by fake::reset()
+namespace fake {
+namespace internal {
+
+void resetClock();
+void resetGpio();
+void resetSerial();
+void resetSpi();
+void resetPreferences();
+void resetPartition();
+void resetBle();
+
+} // namespace internal
+} // namespace fake
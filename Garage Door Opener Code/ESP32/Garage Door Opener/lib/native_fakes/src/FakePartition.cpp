@@ -0,0 +1,87 @@
+#include <esp_partition.h>
+#include <FakeHarness.h>
+
+#include <string.h>
+
+#include "FakeInternal.h"
+
+namespace {
+constexpr uint32_t PARTITION_SIZE = 0x80000;
+
+const esp_partition_t auditPartition = {
+    ESP_PARTITION_TYPE_DATA, static_cast<esp_partition_subtype_t>(0x40), 0x290000, PARTITION_SIZE, "audit", false,
+};
+
+std::vector<uint8_t> flash(PARTITION_SIZE, 0xFF);
+std::vector<uint32_t> erases(PARTITION_SIZE / SPI_FLASH_SEC_SIZE, 0);
+uint32_t writes = 0;
+size_t powerCut = 0;
+
+bool inRange(const esp_partition_t *partition, const size_t offset, const size_t size) {
+    return partition == &auditPartition && offset <= PARTITION_SIZE && size <= PARTITION_SIZE - offset;
+}
+} // namespace
+
+namespace fake {
+
+std::vector<uint8_t> &partitionData() {
+    return flash;
+}
+
+uint32_t partitionWrites() {
+    return writes;
+}
+
+uint32_t partitionErases(const uint32_t sector) {
+    return sector < erases.size() ? erases[sector] : 0;
+}
+
+void cutPowerAfter(const size_t bytes) {
+    powerCut = bytes;
+}
+
+namespace internal {
+void resetPartition() {
+    flash.assign(PARTITION_SIZE, 0xFF);
+    erases.assign(PARTITION_SIZE / SPI_FLASH_SEC_SIZE, 0);
+    writes = 0;
+    powerCut = 0;
+}
+} // namespace internal
+
+} // namespace fake
+
+const esp_partition_t *esp_partition_find_first(const esp_partition_type_t type, const esp_partition_subtype_t subtype,
+                                                const char *label) {
+    if (type != auditPartition.type) return nullptr;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != auditPartition.subtype) return nullptr;
+    if (label && strcmp(label, auditPartition.label) != 0) return nullptr;
+    return &auditPartition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, const size_t src_offset, void *dst, const size_t size) {
+    if (!inRange(partition, src_offset, size)) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, flash.data() + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, const size_t dst_offset, const void *src,
+                              const size_t size) {
+    if (!inRange(partition, dst_offset, size)) return ESP_ERR_INVALID_ARG;
+    size_t length = size;
+    if (powerCut > 0 && powerCut < length) length = powerCut;
+    powerCut = 0;
+    const auto *bytes = static_cast<const uint8_t *>(src);
+    for (size_t i = 0; i < length; i++) flash[dst_offset + i] &= bytes[i]; // Programming only clears bits
+    writes++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, const size_t offset, const size_t size) {
+    if (!inRange(partition, offset, size) || offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(flash.data() + offset, 0xFF, size);
+    for (size_t sector = offset / SPI_FLASH_SEC_SIZE; sector < (offset + size) / SPI_FLASH_SEC_SIZE; sector++) erases[sector]++;
+    return ESP_OK;
+}
@@ -0,0 +1,91 @@
+#include <Preferences.h>
+
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FakeInternal.h"
+
+namespace {
+using Namespace = std::map<std::string, std::vector<uint8_t>>;
+std::map<std::string, Namespace> storage;
+} // namespace
+
+namespace fake {
+namespace internal {
+void resetPreferences() {
+    storage.clear();
+}
+} // namespace internal
+} // namespace fake
+
+bool Preferences::begin(const char *name, const bool readOnly, const char *partitionLabel) {
+    (void)partitionLabel;
+    if (!name || ns) return false;
+    ns = name;
+    this->readOnly = readOnly;
+    storage[ns];
+    return true;
+}
+
+void Preferences::end() {
+    ns = nullptr;
+}
+
+bool Preferences::clear() {
+    if (!ns || readOnly) return false;
+    storage[ns].clear();
+    return true;
+}
+
+bool Preferences::remove(const char *key) {
+    if (!ns || readOnly) return false;
+    return storage[ns].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+    return ns && storage[ns].count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, const size_t length) {
+    if (!ns || readOnly || !key || (!value && length)) return 0;
+    const auto *bytes = static_cast<const uint8_t *>(value);
+    storage[ns][key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, const size_t maxLength) {
+    if (!ns || !key) return 0;
+    const Namespace &entries = storage[ns];
+    const auto it = entries.find(key);
+    if (it == entries.end() || it->second.size() > maxLength) return 0;
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+    if (!ns || !key) return 0;
+    const Namespace &entries = storage[ns];
+    const auto it = entries.find(key);
+    return it == entries.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::putUChar(const char *key, const uint8_t value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint8_t Preferences::getUChar(const char *key, const uint8_t defaultValue) {
+    uint8_t value = defaultValue;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t Preferences::putUInt(const char *key, const uint32_t value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char *key, const uint32_t defaultValue) {
+    uint32_t value = defaultValue;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
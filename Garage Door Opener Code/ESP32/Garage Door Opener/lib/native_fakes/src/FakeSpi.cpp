@@ -0,0 +1,56 @@
+#include <SPI.h>
+#include <FakeHarness.h>
+
+#include "FakeInternal.h"
+
+namespace {
+std::vector<uint16_t> frames;
+uint32_t transactions = 0;
+} // namespace
+
+namespace fake {
+
+const std::vector<uint16_t> &spiFrames() {
+    return frames;
+}
+
+uint32_t spiTransactions() {
+    return transactions;
+}
+
+void clearSpi() {
+    frames.clear();
+    transactions = 0;
+}
+
+namespace internal {
+void resetSpi() {
+    clearSpi();
+}
+} // namespace internal
+
+} // namespace fake
+
+void SPIClass::begin(const int8_t sck, const int8_t miso, const int8_t mosi, const int8_t ss) {
+    (void)sck;
+    (void)miso;
+    (void)mosi;
+    (void)ss;
+}
+
+void SPIClass::beginTransaction(const SPISettings settings) {
+    (void)settings;
+    transactions++;
+}
+
+void SPIClass::endTransaction() {}
+
+uint8_t SPIClass::transfer(const uint8_t data) {
+    frames.push_back(data);
+    return 0;
+}
+
+uint16_t SPIClass::transfer16(const uint16_t data) {
+    frames.push_back(data);
+    return 0;
+}
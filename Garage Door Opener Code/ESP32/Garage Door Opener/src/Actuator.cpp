@@ -0,0 +1,62 @@
+#include "Actuator.h"
+
+Actuator::Actuator(const uint8_t relayPin, const uint32_t pulseMillis)
+    : relayPin(relayPin), pulseMillis(pulseMillis) {}
+
+void Actuator::begin(TaskHandle_t task) {
+    wakeTask = task;
+    pinMode(relayPin, OUTPUT);
+    digitalWrite(relayPin, LOW); // Ensure relay is off on startup
+
+    const esp_timer_create_args_t energizeArgs = {
+        .callback = &Actuator::onEnergizeTimer,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "relay_on",
+        .skip_unhandled_events = false,
+    };
+    esp_timer_create(&energizeArgs, &energizeTimer);
+
+    const esp_timer_create_args_t releaseArgs = {
+        .callback = &Actuator::onReleaseTimer,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "relay_off",
+        .skip_unhandled_events = false,
+    };
+    esp_timer_create(&releaseArgs, &releaseTimer);
+}
+
+bool Actuator::trigger() {
+    bool expected = false;
+    if (!busy.compare_exchange_strong(expected, true)) {
+        return false; // A pulse is already pending or running
+    }
+    // Zero delay: the relay is switched from the esp_timer task, not from the caller
+    if (esp_timer_start_once(energizeTimer, 0) != ESP_OK) {
+        busy = false;
+        return false;
+    }
+    return true;
+}
+
+uint8_t Actuator::takeEvents() {
+    return events.exchange(0);
+}
+
+void Actuator::onEnergizeTimer(void *arg) {
+    auto *self = static_cast<Actuator *>(arg);
+    digitalWrite(self->relayPin, HIGH); // Activate the relay
+    self->energizedAt = latencyTimestamp();
+    self->events |= ACTUATION_ENERGIZED;
+    if (self->wakeTask) xTaskNotifyGive(self->wakeTask);
+    esp_timer_start_once(self->releaseTimer, static_cast<uint64_t>(self->pulseMillis) * 1000);
+}
+
+void Actuator::onReleaseTimer(void *arg) {
+    auto *self = static_cast<Actuator *>(arg);
+    digitalWrite(self->relayPin, LOW); // Deactivate the relay
+    self->events |= ACTUATION_RELEASED;
+    self->busy = false;
+    if (self->wakeTask) xTaskNotifyGive(self->wakeTask);
+}
@@ -0,0 +1,56 @@
+#include "AdvertisingPolicy.h"
+
+#include "AppState.h"
+#include "BleBackend.h"
+
+static uint8_t whitelistedBonds = 0; // Leading bondAllowlist entries already in the controller whitelist
+static uint8_t syncedBonds = 0;      // bondAllowlist.size() at the last sync
+static uint32_t syncedRevision = 0;  // bondAllowlist.revision() at the last sync
+
+// Copies new bonds into the controller whitelist. The controller refuses whitelist changes
+// while advertising filters on it, so only call this with advertising stopped.
+static void syncWhitelist() {
+    const uint8_t bonds = bondAllowlist.size();
+    const uint32_t revision = bondAllowlist.revision();
+    if (bonds == syncedBonds && revision == syncedRevision) return;
+    syncedBonds = bonds;
+
+    if (revision != syncedRevision) { // Bonds were revoked or cleared, entries may have moved
+        syncedRevision = revision;
+        ble::clearWhitelist();
+        whitelistedBonds = 0;
+    }
+    const uint8_t capacity = ble::whitelistCapacity();
+    while (whitelistedBonds < bonds && whitelistedBonds < capacity) {
+        if (!ble::addToWhitelist(bondAllowlist.addressAt(whitelistedBonds), bondAllowlist.addressTypeAt(whitelistedBonds))) break;
+        whitelistedBonds++;
+    }
+    if (whitelistedBonds < bonds) {
+        LOG_WARN(LOG_WHITELIST_SHORT, whitelistedBonds, bonds);
+    }
+}
+
+void loadWhitelist() {
+    if (!ADVERTISING_FILTER_ENABLED) return;
+    ble::clearWhitelist();
+    whitelistedBonds = 0;
+    syncedBonds = 0;
+    syncedRevision = bondAllowlist.revision();
+    syncWhitelist();
+}
+
+void startAdvertising() {
+    ble::stopAdvertising(); // The filter policy only applies from the next start
+    if (!ADVERTISING_FILTER_ENABLED) {
+        ble::startAdvertising(false);
+        return;
+    }
+    syncWhitelist();
+    // Open while pairing, or when filtering would lock out a bond the whitelist could not hold
+    const bool filtered = !allowNewPairing && !bondAllowlist.isEmpty() && whitelistedBonds == bondAllowlist.size();
+    ble::startAdvertising(filtered);
+}
+
+void stopAdvertising() {
+    ble::stopAdvertising();
+}
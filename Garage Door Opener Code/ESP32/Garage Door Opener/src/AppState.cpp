@@ -0,0 +1,36 @@
+#include "AppState.h"
+
+BootTimeline bootTimeline;
+
+Max7219Display display(DIN_PIN, CLK_PIN, CS_PIN);
+DisplayEngine displayEngine(display);
+Logger logger;
+
+BondAllowlist bondAllowlist;
+
+Actuator actuator(RELAY_PIN, RELAY_PULSE_MILLIS);
+
+uint32_t triggerWrittenAt = 0;
+
+Telemetry telemetry;
+
+ConnectionTable connections;
+CommandQueue commandQueue;
+ConnParamManager connParams;
+AuditLog auditLog;
+DeviceRegistry deviceRegistry;
+
+std::atomic<uint32_t> currentDisplayedPasskey{0};
+std::atomic<bool> pairingModeActive{false};
+std::atomic<bool> allowNewPairing{false};
+
+Scheduler scheduler;
+
+ButtonMonitor button(BUTTON_PIN, PAIRING_PRESS_DURATION_MILLIS, FACTORY_RESET_PRESS_DURATION);
+DoorSensor doorSensor(DOOR_CLOSED_PIN, DOOR_OPEN_PIN, DOOR_TRAVEL_MILLIS);
+std::atomic<uint16_t> doorStatus{0};
+
+TaskHandle_t loopTaskHandle = nullptr;
+
+SpscRing<BleEvent, BLE_EVENT_QUEUE_SIZE> bleEvents;
+uint32_t bleEventCounts[static_cast<uint8_t>(BleEventType::Count)] = {};
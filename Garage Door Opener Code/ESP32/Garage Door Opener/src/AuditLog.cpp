@@ -0,0 +1,128 @@
+#include "AuditLog.h"
+
+static bool isBlank(const AuditRecord &record) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&record);
+    for (size_t i = 0; i < sizeof(AuditRecord); i++) {
+        if (bytes[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+uint8_t AuditLog::checksum(const AuditRecord &record) {
+    // Rotate and xor over everything but the check byte; an erased record (all 0xFF) fails it
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&record);
+    uint8_t sum = 0xA5;
+    for (size_t i = 0; i < offsetof(AuditRecord, check); i++) sum = static_cast<uint8_t>((sum << 1 | sum >> 7) ^ bytes[i]);
+    return sum;
+}
+
+bool AuditLog::readSlot(const uint32_t slot, AuditRecord &record) const {
+    return esp_partition_read(partition, slot * sizeof(AuditRecord), &record, sizeof(AuditRecord)) == ESP_OK;
+}
+
+bool AuditLog::begin() {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                         static_cast<esp_partition_subtype_t>(AUDIT_PARTITION_SUBTYPE), AUDIT_PARTITION_LABEL);
+    if (!partition) return false;
+    slots = partition->size / SPI_FLASH_SEC_SIZE * RECORDS_PER_SECTOR;
+
+    // The newest sector starts with the highest sequence and the oldest with the lowest. A sector
+    // whose first record is torn or blank is treated as free; it is erased before it is written.
+    bool found = false;
+    uint32_t newestSector = 0;
+    uint32_t newestFirst = 0;
+    uint32_t oldestFirst = 0;
+    for (uint32_t slot = 0; slot < slots; slot += RECORDS_PER_SECTOR) {
+        AuditRecord first;
+        if (!readSlot(slot, first) || !isValid(first)) continue;
+        if (!found || first.sequence > newestFirst) {
+            newestSector = slot / RECORDS_PER_SECTOR;
+            newestFirst = first.sequence;
+        }
+        if (!found || first.sequence < oldestFirst) oldestFirst = first.sequence;
+        found = true;
+    }
+    if (!found) {
+        head = oldest = next = 0;
+        return true;
+    }
+
+    // The log ends at the first blank slot of the newest sector, or with that sector
+    uint32_t used = 1;
+    while (used < RECORDS_PER_SECTOR) {
+        AuditRecord record;
+        if (!readSlot(newestSector * RECORDS_PER_SECTOR + used, record) || isBlank(record)) break;
+        used++;
+    }
+    head = (newestSector * RECORDS_PER_SECTOR + used) % slots;
+    next = newestFirst + used;
+    oldest = oldestFirst;
+    return true;
+}
+
+void AuditLog::append(const AuditEvent event, const uint8_t *address, const unsigned long now) {
+    if (batchCount == AUDIT_BATCH_RECORDS) {
+        dropped++; // Only without a partition, a full batch is flushed right away otherwise
+        return;
+    }
+    AuditRecord &record = batch[batchCount++];
+    record = {};
+    record.uptimeSeconds = now / 1000;
+    record.event = static_cast<uint8_t>(event);
+    if (address) memcpy(record.address, address, sizeof(record.address));
+    if (batchCount == AUDIT_BATCH_RECORDS) flush();
+}
+
+void AuditLog::flush() {
+    if (!partition || batchCount == 0) return;
+
+    // Sequences are handed out here, so records queued before begin() still line up
+    for (uint8_t i = 0; i < batchCount; i++) {
+        batch[i].sequence = next + i;
+        batch[i].check = checksum(batch[i]);
+    }
+    uint32_t done = 0;
+    while (done < batchCount) {
+        const uint32_t room = RECORDS_PER_SECTOR - head % RECORDS_PER_SECTOR;
+        const uint32_t run = batchCount - done < room ? batchCount - done : room;
+        writeRun(batch + done, run);
+        done += run;
+    }
+    batchCount = 0;
+}
+
+// Writes records that fit in the current sector, erasing it first when the ring wraps onto it
+void AuditLog::writeRun(const AuditRecord *records, const uint32_t count) {
+    if (head % RECORDS_PER_SECTOR == 0) {
+        AuditRecord first;
+        if (readSlot(head, first) && !isBlank(first)) {
+            esp_partition_erase_range(partition, head * sizeof(AuditRecord), SPI_FLASH_SEC_SIZE);
+            erases++;
+            // That sector held the oldest records
+            if (isValid(first) && first.sequence + RECORDS_PER_SECTOR > oldest) oldest = first.sequence + RECORDS_PER_SECTOR;
+        }
+    }
+    esp_partition_write(partition, head * sizeof(AuditRecord), records, count * sizeof(AuditRecord));
+    writes++;
+    head = (head + count) % slots;
+    next += count;
+}
+
+size_t AuditLog::read(uint32_t from, AuditRecord *out, const size_t max) const {
+    if (!partition) return 0;
+    if (from < oldest) from = oldest;
+    if (from >= next) return 0;
+
+    const uint32_t available = next - from;
+    const uint32_t count = max < available ? max : available;
+    uint32_t slot = (head + slots - available) % slots;
+    uint32_t copied = 0;
+    while (copied < count) {
+        // Split where the ring wraps to the start of the partition
+        const uint32_t run = count - copied < slots - slot ? count - copied : slots - slot;
+        esp_partition_read(partition, slot * sizeof(AuditRecord), out + copied, run * sizeof(AuditRecord));
+        copied += run;
+        slot = 0;
+    }
+    return count;
+}
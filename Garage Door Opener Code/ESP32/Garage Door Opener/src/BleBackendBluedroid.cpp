@@ -0,0 +1,295 @@
+#ifndef BLE_BACKEND_NIMBLE
+
+#include "BleBackend.h"
+
+#include <BLEDevice.h>
+#include <BLEUtils.h>
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include <Preferences.h>
+
+#include "esp_gatts_api.h"
+#include "esp_heap_caps.h"
+
+#include "BleCallbacks.h"
+#include "Config.h"
+#include "ConnParamManager.h"
+#include "Log.h"
+
+// The Arduino Bluedroid wrapper plus the raw esp_ble_* calls it does not cover
+
+static BLEServer *server = nullptr;
+static BLECharacteristic *characteristics[static_cast<uint8_t>(BleCharacteristic::Count)] = {};
+static BLEDescriptor *cccds[static_cast<uint8_t>(BleCharacteristic::Count)] = {}; // nullptr unless it notifies
+
+static BLECharacteristic *characteristic(const BleCharacteristic which) {
+    return characteristics[static_cast<uint8_t>(which)];
+}
+
+// --- Wrapper callbacks, translated for BleCallbacks.cpp ---
+
+class ServerCallbacks : public BLEServerCallbacks {
+public:
+    void onConnect(BLEServer *, esp_ble_gatts_cb_param_t *param) override {
+        onBleConnect(param->connect.conn_id, param->connect.remote_bda);
+    }
+
+    void onDisconnect(BLEServer *, esp_ble_gatts_cb_param_t *param) override {
+        onBleDisconnect(param->disconnect.conn_id, param->disconnect.remote_bda);
+    }
+};
+
+class SecurityCallbacks : public BLESecurityCallbacks {
+public:
+    void onPassKeyNotify(uint32_t pass_key) override {
+        onBlePasskeyNotify(pass_key);
+    }
+
+    //NOT USED
+    uint32_t onPassKeyRequest() override {
+        LOG_WARN(LOG_PASSKEY_REQUEST);
+        return 0; // Return 0 as ESP32 is not designed to receive passkey input in this mode
+    }
+
+    //NOT USED
+    bool onConfirmPIN(uint32_t pin) override {
+        LOG_WARN(LOG_CONFIRM_PIN, pin);
+        // In a Numeric Comparison scenario, you'd ask the user to confirm match.
+        // For Passkey Entry, this is not relevant.
+        return true; // Assuming confirmation if hit, though ideally not.
+    }
+
+    bool onSecurityRequest() override {
+        return onBleSecurityRequest();
+    }
+
+    void onAuthenticationComplete(esp_ble_auth_cmpl_t auth_cmpl) override {
+        onBleAuthenticationComplete(auth_cmpl.bd_addr, auth_cmpl.addr_type, auth_cmpl.success, auth_cmpl.fail_reason);
+    }
+};
+
+class CharacteristicCallbacks : public BLECharacteristicCallbacks {
+public:
+    explicit CharacteristicCallbacks(const BleCharacteristic which) : which(which) {}
+
+    void onWrite(BLECharacteristic *pCharacteristic, esp_ble_gatts_cb_param_t *param) override {
+        // Parse straight from the characteristic's buffer, no copy into a std::string
+        onBleWrite(param->write.conn_id, param->write.bda, pCharacteristic->getData(), pCharacteristic->getLength());
+    }
+
+    void onRead(BLECharacteristic *) override {
+        onBleRead(which);
+    }
+
+private:
+    const BleCharacteristic which;
+};
+
+// GAP events the Arduino wrapper does not surface
+static void onGapEvent(const esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    if (event != ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT) return;
+
+    // Reported for every change, whichever side asked for it; the event carries no conn_id
+    const auto &update = param->update_conn_params;
+    onBleConnParamsUpdated(update.bda, update.status == ESP_BT_STATUS_SUCCESS, update.status,
+                           {update.conn_int, update.latency, update.timeout});
+}
+
+// GATTS events the Arduino wrapper does not surface per connection. BLE2902 keeps a single
+// value for every client, so the CCCD writes are picked up here, where the conn_id is known.
+static void onGattsEvent(const esp_gatts_cb_event_t event, esp_gatt_if_t, esp_ble_gatts_cb_param_t *param) {
+    if (event != ESP_GATTS_WRITE_EVT || param->write.is_prep || param->write.len != 2) return;
+    for (uint8_t i = 0; i < static_cast<uint8_t>(BleCharacteristic::Count); i++) {
+        if (!cccds[i] || cccds[i]->getHandle() != param->write.handle) continue;
+        onBleSubscribe(param->write.conn_id, static_cast<BleCharacteristic>(i), param->write.value[0] & 0x01);
+        return;
+    }
+}
+
+namespace ble {
+
+void init(const char *name, const uint16_t localMtu) {
+    BLEDevice::init(name);
+    BLEDevice::setMTU(localMtu);
+    BLEDevice::setSecurityCallbacks(new SecurityCallbacks());
+    BLEDevice::setCustomGapHandler(onGapEvent); // Reports the connection parameters the centrals settle on
+    BLEDevice::setCustomGattsHandler(onGattsEvent); // Tracks which link enabled which notifications
+}
+
+void startServer() {
+    server = BLEDevice::createServer();
+    server->setCallbacks(new ServerCallbacks()); // Set server-level callbacks for connect/disconnect
+    BLEService *pService = server->createService(SERVICE_UUID);
+
+    // Commands, replies and the door status
+    BLECharacteristic *control = pService->createCharacteristic(
+                                    CHARACTERISTIC_UUID,
+                                    BLECharacteristic::PROPERTY_WRITE |
+                                    BLECharacteristic::PROPERTY_WRITE_NR | // Write without response
+                                    BLECharacteristic::PROPERTY_READ |
+                                    BLECharacteristic::PROPERTY_NOTIFY
+                                );
+    control->setCallbacks(new CharacteristicCallbacks(BleCharacteristic::Control));
+    control->setValue("Hello from Secure ESP32!"); // Initial value
+    // Add a standard Client Characteristic Configuration Descriptor (CCCD)
+    // This allows clients to enable/disable notifications for this characteristic.
+    BLEDescriptor *controlCccd = new BLE2902();
+    control->addDescriptor(controlCccd);
+
+    // Second characteristic exporting the latency histograms and counters as a binary blob.
+    // Counts and timings of the bonded phones' activity, so reads need an encrypted MITM link too.
+    BLECharacteristic *stats = pService->createCharacteristic(
+                                    STATS_CHARACTERISTIC_UUID,
+                                    BLECharacteristic::PROPERTY_READ
+                                );
+    stats->setAccessPermissions(ESP_GATT_PERM_READ_ENC_MITM);
+
+    // Third characteristic streaming the audit log after an OP_AUDIT_READ command
+    BLECharacteristic *audit = pService->createCharacteristic(
+                                    AUDIT_CHARACTERISTIC_UUID,
+                                    BLECharacteristic::PROPERTY_NOTIFY
+                                );
+    BLEDescriptor *auditCccd = new BLE2902();
+    audit->addDescriptor(auditCccd);
+
+    // Fourth characteristic: the device registry records, kept current by the loop task.
+    // Addresses and names are only for bonded phones, so reads need an encrypted MITM link.
+    BLECharacteristic *devices = pService->createCharacteristic(
+                                    DEVICES_CHARACTERISTIC_UUID,
+                                    BLECharacteristic::PROPERTY_READ
+                                );
+    devices->setAccessPermissions(ESP_GATT_PERM_READ_ENC_MITM);
+
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Control)] = control;
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Stats)] = stats;
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Audit)] = audit;
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Devices)] = devices;
+    cccds[static_cast<uint8_t>(BleCharacteristic::Control)] = controlCccd;
+    cccds[static_cast<uint8_t>(BleCharacteristic::Audit)] = auditCccd;
+
+    // Start the BLE Service
+    pService->start();
+
+    // Add your custom service UUID to the advertising data.
+    // This allows clients to scan for and discover your specific service.
+    BLEAdvertising *pAdvertising = server->getAdvertising();
+    pAdvertising->addServiceUUID(SERVICE_UUID);
+    // Connection interval advertised as preferred; once a link authenticates the
+    // ConnParamManager switches it between the fast and idle profiles
+    pAdvertising->setMinPreferred(DEFAULT_FAST_PROFILE.minInterval);
+    pAdvertising->setMaxPreferred(DEFAULT_FAST_PROFILE.maxInterval);
+
+    // --- Core BLE Security Configuration ---
+    auto *pSecurity = new BLESecurity();
+
+    // 1. Set Authentication Mode:
+    //    ESP_LE_AUTH_REQ_SC_MITM_BOND is the most secure option:
+    //    - SC (Secure Connections): Uses robust Elliptic Curve Diffie-Hellman (ECDH) for key exchange.
+    //    - MITM (Man-in-the-Middle Protection): Ensures a pairing method is used that protects against MITM attacks.
+    //    - BOND (Bonding): Stores the keys (LTK) so devices can reconnect securely later without re-pairing.
+    pSecurity->setAuthenticationMode(ESP_LE_AUTH_REQ_SC_MITM_BOND);
+
+    // 2. Set I/O Capabilities:
+    //    ESP_IO_CAP_OUT (Display Only): Tells the peer that THIS ESP32 can display a passkey,
+    //    but it does not have a keyboard for user input.
+    //    Combined with MITM requirement, this forces 'Passkey Entry' where ESP32 displays the key.
+    pSecurity->setCapability(ESP_IO_CAP_OUT);
+
+    // 3. Set the encryption key size range (optional, defaults are usually fine for 128-bit AES)
+    //    ESP_BLE_ENC_KEY_MASK: Enable encryption keys.
+    //    ESP_BLE_ID_KEY_MASK: Enable identity keys (for privacy and device identification).
+    pSecurity->setInitEncryptionKey(ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK);
+}
+
+void setValue(const BleCharacteristic which, const uint8_t *data, const size_t length) {
+    BLECharacteristic *target = characteristic(which);
+    if (target) target->setValue(const_cast<uint8_t *>(data), length);
+}
+
+bool notify(const BleCharacteristic which, const uint16_t connId, const uint8_t *data, const size_t length) {
+    return esp_ble_gatts_send_indicate(server->getGattsIf(), connId, characteristic(which)->getHandle(), length,
+                                       const_cast<uint8_t *>(data), false) == ESP_OK;
+}
+
+uint16_t peerMtu(const uint16_t connId) {
+    return server->getPeerMTU(connId);
+}
+
+void disconnect(const uint16_t connId) {
+    server->disconnect(connId);
+}
+
+uint32_t requestEncryption(uint16_t, const esp_bd_addr_t address) {
+    return esp_ble_set_encryption(const_cast<uint8_t *>(address), ESP_BLE_SEC_ENCRYPT_MITM);
+}
+
+void updateConnParams(uint16_t, const esp_bd_addr_t address, const uint16_t minInterval, const uint16_t maxInterval,
+                      const uint16_t latency, const uint16_t timeout) {
+    esp_ble_conn_update_params_t params{};
+    memcpy(params.bda, address, ESP_BD_ADDR_LEN);
+    params.min_int = minInterval;
+    params.max_int = maxInterval;
+    params.latency = latency;
+    params.timeout = timeout;
+    esp_ble_gap_update_conn_params(&params);
+}
+
+uint8_t listBonds(esp_bd_addr_t *addresses, esp_ble_addr_type_t *types, const uint8_t capacity) {
+    int dev_num = esp_ble_get_bond_device_num();
+    if (dev_num <= 0) return 0;
+
+    auto *bond_dev_list = static_cast<esp_ble_bond_dev_t *>(heap_caps_malloc(sizeof(esp_ble_bond_dev_t) * dev_num,
+                                                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (!bond_dev_list) return 0;
+
+    esp_ble_get_bond_device_list(&dev_num, bond_dev_list);
+    const uint8_t copied = dev_num < capacity ? dev_num : capacity;
+    for (uint8_t i = 0; i < copied; i++) {
+        memcpy(addresses[i], bond_dev_list[i].bd_addr, ESP_BD_ADDR_LEN);
+        // bd_addr is the identity address; its type only comes with the peer's identity key
+        const esp_ble_bond_key_info_t &keys = bond_dev_list[i].bond_key;
+        types[i] = (keys.key_mask & ESP_LE_KEY_PID) ? keys.pid_key.addr_type : BLE_ADDR_TYPE_PUBLIC;
+    }
+    heap_caps_free(bond_dev_list);
+    return copied;
+}
+
+void removeBond(const esp_bd_addr_t address) {
+    esp_ble_remove_bond_device(const_cast<uint8_t *>(address));
+}
+
+void clearBonds() {
+    Preferences preferences;
+    preferences.begin("nvs", false); // Open preferences with namespace "nvs" where ESP32 BT/BLE info is stored
+    preferences.clear(); // Clear all preferences under this namespace
+    preferences.end(); // Close the preferences
+}
+
+void clearWhitelist() {
+    esp_ble_gap_clear_whitelist();
+}
+
+uint8_t whitelistCapacity() {
+    uint16_t capacity = 0;
+    if (esp_ble_gap_get_whitelist_size(&capacity) != ESP_OK) return 0;
+    return capacity > UINT8_MAX ? UINT8_MAX : capacity;
+}
+
+bool addToWhitelist(const esp_bd_addr_t address, const esp_ble_addr_type_t type) {
+    return esp_ble_gap_update_whitelist(true, const_cast<uint8_t *>(address),
+                                        static_cast<esp_ble_wl_addr_type_t>(type)) == ESP_OK;
+}
+
+void startAdvertising(const bool filtered) {
+    BLEAdvertising *advertising = server->getAdvertising();
+    advertising->setScanFilter(filtered, filtered);
+    advertising->start();
+}
+
+void stopAdvertising() {
+    server->getAdvertising()->stop();
+}
+
+} // namespace ble
+
+#endif // BLE_BACKEND_NIMBLE
@@ -0,0 +1,263 @@
+#ifdef BLE_BACKEND_NIMBLE
+
+#include "BleBackend.h"
+
+#include <NimBLEDevice.h>
+
+#include "BleCallbacks.h"
+#include "BondAllowlist.h"
+#include "Config.h"
+#include "ConnParamManager.h"
+#include "Log.h"
+
+// NimBLE-Arduino 1.4. The host keeps addresses least significant byte first, the firmware in
+// esp_bd_addr_t order, so every address is flipped on its way through this file.
+
+static NimBLEServer *server = nullptr;
+static NimBLECharacteristic *characteristics[static_cast<uint8_t>(BleCharacteristic::Count)] = {};
+
+static NimBLECharacteristic *characteristic(const BleCharacteristic which) {
+    return characteristics[static_cast<uint8_t>(which)];
+}
+
+static void toBda(const uint8_t *native, esp_bd_addr_t address) {
+    for (uint8_t i = 0; i < ESP_BD_ADDR_LEN; i++) address[i] = native[ESP_BD_ADDR_LEN - 1 - i];
+}
+
+// Identity address types have the same values in both stacks: public 0, random static 1
+static NimBLEAddress toNimble(const esp_bd_addr_t address, const esp_ble_addr_type_t type) {
+    ble_addr_t native{};
+    native.type = type;
+    for (uint8_t i = 0; i < ESP_BD_ADDR_LEN; i++) native.val[i] = address[ESP_BD_ADDR_LEN - 1 - i];
+    return NimBLEAddress(native);
+}
+
+// --- Host callbacks, translated for BleCallbacks.cpp ---
+
+class ServerCallbacks : public NimBLEServerCallbacks {
+public:
+    void onConnect(NimBLEServer *, ble_gap_conn_desc *desc) override {
+        esp_bd_addr_t address;
+        toBda(desc->peer_id_addr.val, address); // Resolved when the peer's identity key is known
+        onBleConnect(desc->conn_handle, address);
+    }
+
+    void onDisconnect(NimBLEServer *, ble_gap_conn_desc *desc) override {
+        esp_bd_addr_t address;
+        toBda(desc->peer_id_addr.val, address);
+        onBleDisconnect(desc->conn_handle, address);
+    }
+
+    // Display-only passkey entry: NimBLE asks for the passkey it should show, Bluedroid picks
+    // one itself. A pairing outside the window is refused (and the link dropped) here, as
+    // NimBLE has no counterpart to Bluedroid's security request callback.
+    uint32_t onPassKeyRequest() override {
+        const uint32_t passkey = esp_random() % 1000000;
+        onBlePasskeyNotify(passkey);
+        return passkey;
+    }
+
+    //NOT USED
+    bool onConfirmPIN(uint32_t pin) override {
+        LOG_WARN(LOG_CONFIRM_PIN, pin);
+        return true; // Same answer as the Bluedroid build; display-only IO never negotiates numeric comparison
+    }
+
+    void onAuthenticationComplete(ble_gap_conn_desc *desc) override {
+        esp_bd_addr_t address;
+        toBda(desc->peer_id_addr.val, address);
+        // The policy wants an authenticated (MITM) bond, plain encryption is not enough.
+        // NimBLE does not pass a failure reason here.
+        const bool success = desc->sec_state.encrypted && desc->sec_state.authenticated && desc->sec_state.bonded;
+        onBleAuthenticationComplete(address, static_cast<esp_ble_addr_type_t>(desc->peer_id_addr.type), success, 0);
+    }
+};
+
+class CharacteristicCallbacks : public NimBLECharacteristicCallbacks {
+public:
+    explicit CharacteristicCallbacks(const BleCharacteristic which) : which(which) {}
+
+    void onWrite(NimBLECharacteristic *pCharacteristic, ble_gap_conn_desc *desc) override {
+        esp_bd_addr_t address;
+        toBda(desc->peer_id_addr.val, address);
+        const NimBLEAttValue value = pCharacteristic->getValue(); // 1.4 only hands out copies
+        onBleWrite(desc->conn_handle, address, value.data(), value.length());
+    }
+
+    void onRead(NimBLECharacteristic *, ble_gap_conn_desc *) override {
+        onBleRead(which);
+    }
+
+    // Also called when the host restores a bonded peer's stored CCCD on reconnect
+    void onSubscribe(NimBLECharacteristic *, ble_gap_conn_desc *desc, uint16_t subValue) override {
+        onBleSubscribe(desc->conn_handle, which, subValue & 0x0001);
+    }
+
+private:
+    const BleCharacteristic which;
+};
+
+// GAP events the server callbacks do not surface
+static int onGapEvent(ble_gap_event *event, void *) {
+    if (event->type != BLE_GAP_EVENT_CONN_UPDATE) return 0;
+
+    // Reported for every change, whichever side asked for it; the values live in the connection
+    ble_gap_conn_desc desc{};
+    if (ble_gap_conn_find(event->conn_update.conn_handle, &desc) != 0) return 0;
+    esp_bd_addr_t address;
+    toBda(desc.peer_id_addr.val, address);
+    onBleConnParamsUpdated(address, event->conn_update.status == 0, event->conn_update.status,
+                           {desc.conn_itvl, desc.conn_latency, desc.supervision_timeout});
+    return 0;
+}
+
+namespace ble {
+
+void init(const char *name, const uint16_t localMtu) {
+    NimBLEDevice::init(name);
+    NimBLEDevice::setMTU(localMtu);
+    NimBLEDevice::setCustomGapHandler(onGapEvent); // Reports the connection parameters the centrals settle on
+}
+
+void startServer() {
+    server = NimBLEDevice::createServer();
+    server->setCallbacks(new ServerCallbacks());
+    server->advertiseOnDisconnect(false); // AdvertisingPolicy restarts it, filtered or not, as Bluedroid does
+    NimBLEService *service = server->createService(SERVICE_UUID);
+
+    // NimBLE adds the CCCD (0x2902) to every notifying characteristic itself
+    NimBLECharacteristic *control = service->createCharacteristic(
+                                    CHARACTERISTIC_UUID,
+                                    NIMBLE_PROPERTY::WRITE |
+                                    NIMBLE_PROPERTY::WRITE_NR |
+                                    NIMBLE_PROPERTY::READ |
+                                    NIMBLE_PROPERTY::NOTIFY
+                                );
+    control->setCallbacks(new CharacteristicCallbacks(BleCharacteristic::Control));
+    control->setValue("Hello from Secure ESP32!");
+
+    // Stats and registry reads need an encrypted MITM link, as with ESP_GATT_PERM_READ_ENC_MITM on Bluedroid
+    NimBLECharacteristic *stats = service->createCharacteristic(
+                                    STATS_CHARACTERISTIC_UUID,
+                                    NIMBLE_PROPERTY::READ |
+                                    NIMBLE_PROPERTY::READ_ENC |
+                                    NIMBLE_PROPERTY::READ_AUTHEN
+                                );
+
+    NimBLECharacteristic *audit = service->createCharacteristic(AUDIT_CHARACTERISTIC_UUID, NIMBLE_PROPERTY::NOTIFY);
+    audit->setCallbacks(new CharacteristicCallbacks(BleCharacteristic::Audit)); // Subscriptions only
+
+    NimBLECharacteristic *devices = service->createCharacteristic(
+                                    DEVICES_CHARACTERISTIC_UUID,
+                                    NIMBLE_PROPERTY::READ |
+                                    NIMBLE_PROPERTY::READ_ENC |
+                                    NIMBLE_PROPERTY::READ_AUTHEN
+                                );
+
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Control)] = control;
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Stats)] = stats;
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Audit)] = audit;
+    characteristics[static_cast<uint8_t>(BleCharacteristic::Devices)] = devices;
+
+    service->start();
+    server->start();
+
+    NimBLEAdvertising *advertising = NimBLEDevice::getAdvertising();
+    advertising->addServiceUUID(SERVICE_UUID);
+    advertising->setMinPreferred(DEFAULT_FAST_PROFILE.minInterval);
+    advertising->setMaxPreferred(DEFAULT_FAST_PROFILE.maxInterval);
+
+    // Same policy as the Bluedroid build: bonding, MITM, Secure Connections, and display-only
+    // IO so the passkey is shown here and typed on the phone. Both sides hand out their
+    // encryption and identity keys.
+    NimBLEDevice::setSecurityAuth(true, true, true);
+    NimBLEDevice::setSecurityIOCap(BLE_HS_IO_DISPLAY_ONLY);
+    NimBLEDevice::setSecurityInitKey(BLE_SM_PAIR_KEY_DIST_ENC | BLE_SM_PAIR_KEY_DIST_ID);
+    NimBLEDevice::setSecurityRespKey(BLE_SM_PAIR_KEY_DIST_ENC | BLE_SM_PAIR_KEY_DIST_ID);
+}
+
+void setValue(const BleCharacteristic which, const uint8_t *data, const size_t length) {
+    NimBLECharacteristic *target = characteristic(which);
+    if (target) target->setValue(data, length);
+}
+
+bool notify(const BleCharacteristic which, const uint16_t connId, const uint8_t *data, const size_t length) {
+    // NimBLECharacteristic::notify() goes to every subscriber; the host call takes one connection
+    os_mbuf *buffer = ble_hs_mbuf_from_flat(data, length);
+    if (!buffer) return false;
+    return ble_gattc_notify_custom(connId, characteristic(which)->getHandle(), buffer) == 0; // Consumes buffer
+}
+
+uint16_t peerMtu(const uint16_t connId) {
+    return server->getPeerMTU(connId);
+}
+
+void disconnect(const uint16_t connId) {
+    server->disconnect(connId);
+}
+
+uint32_t requestEncryption(const uint16_t connId, const esp_bd_addr_t) {
+    return ble_gap_security_initiate(connId);
+}
+
+void updateConnParams(const uint16_t connId, const esp_bd_addr_t, const uint16_t minInterval,
+                      const uint16_t maxInterval, const uint16_t latency, const uint16_t timeout) {
+    server->updateConnParams(connId, minInterval, maxInterval, latency, timeout);
+}
+
+uint8_t listBonds(esp_bd_addr_t *addresses, esp_ble_addr_type_t *types, const uint8_t capacity) {
+    const int bonds = NimBLEDevice::getNumBonds();
+    const uint8_t copied = bonds < capacity ? bonds : capacity;
+    for (uint8_t i = 0; i < copied; i++) {
+        const NimBLEAddress bonded = NimBLEDevice::getBondedAddress(i); // Identity address
+        toBda(bonded.getNative(), addresses[i]);
+        types[i] = static_cast<esp_ble_addr_type_t>(bonded.getType());
+    }
+    return copied;
+}
+
+void removeBond(const esp_bd_addr_t address) {
+    // The host matches the address type too, so take it from the bond itself
+    const int bonds = NimBLEDevice::getNumBonds();
+    for (int i = 0; i < bonds; i++) {
+        const NimBLEAddress bonded = NimBLEDevice::getBondedAddress(i);
+        esp_bd_addr_t candidate;
+        toBda(bonded.getNative(), candidate);
+        if (memcmp(candidate, address, ESP_BD_ADDR_LEN) != 0) continue;
+        NimBLEDevice::deleteBond(bonded);
+        return;
+    }
+}
+
+void clearBonds() {
+    NimBLEDevice::deleteAllBonds();
+}
+
+void clearWhitelist() {
+    while (NimBLEDevice::getWhiteListCount() > 0) {
+        NimBLEDevice::whiteListRemove(NimBLEDevice::getWhiteListAddress(0));
+    }
+}
+
+uint8_t whitelistCapacity() {
+    // NimBLE does not report the controller's size; a full whitelist shows up as a failed add
+    return MAX_BONDED_DEVICES;
+}
+
+bool addToWhitelist(const esp_bd_addr_t address, const esp_ble_addr_type_t type) {
+    return NimBLEDevice::whiteListAdd(toNimble(address, type));
+}
+
+void startAdvertising(const bool filtered) {
+    NimBLEAdvertising *advertising = NimBLEDevice::getAdvertising();
+    advertising->setScanFilter(filtered, filtered);
+    advertising->start();
+}
+
+void stopAdvertising() {
+    NimBLEDevice::getAdvertising()->stop();
+}
+
+} // namespace ble
+
+#endif // BLE_BACKEND_NIMBLE
@@ -0,0 +1,170 @@
+#include "BleCallbacks.h"
+
+#include "AppState.h"
+
+// Hands an event from the BLE task to loop() and wakes it. Never blocks; a full queue drops the event.
+static void postBleEvent(const BleEvent &event) {
+    if (bleEvents.push(event) && loopTaskHandle) xTaskNotifyGive(loopTaskHandle);
+}
+
+static BleEvent makeBleEvent(const BleEventType type, const uint16_t connId = 0, const uint8_t *address = nullptr) {
+    BleEvent event{};
+    event.type = type;
+    event.connId = connId;
+    event.timestamp = latencyTimestamp();
+    if (address) memcpy(event.address, address, ESP_BD_ADDR_LEN);
+    return event;
+}
+
+// --- 1. Connection events ---
+void onBleConnect(const uint16_t connId, const esp_bd_addr_t address) {
+    const uint32_t connectedAt = latencyTimestamp();
+
+    // Check if we have any bonded devices and if we're not in pairing mode
+    const bool unknownOutsidePairing = !bondAllowlist.isEmpty() && !allowNewPairing && !bondAllowlist.contains(address);
+    // If the connecting device is not bonded and we're not in pairing mode (or every slot is taken), disconnect
+    if (unknownOutsidePairing || !connections.add(connId, address, connectedAt)) {
+        ble::disconnect(connId);
+        telemetry.count(COUNTER_REJECTED_CONNECTIONS);
+        postBleEvent(makeBleEvent(BleEventType::ConnectRejected, connId, address));
+        return;
+    }
+
+    BleEvent event = makeBleEvent(BleEventType::Connected, connId, address);
+    event.value = ble::requestEncryption(connId, address);
+    const uint32_t encryptionRequestedAt = latencyTimestamp();
+    connections.encryptionRequested(connId, encryptionRequestedAt); // Per link, two phones may be encrypting at once
+    telemetry.record(HIST_CONNECT_TO_ENCRYPT, encryptionRequestedAt - connectedAt);
+    postBleEvent(event);
+}
+
+void onBleDisconnect(const uint16_t connId, const esp_bd_addr_t address) {
+    connections.remove(connId);
+    postBleEvent(makeBleEvent(BleEventType::Disconnected, connId, address));
+}
+
+// This callback is triggered when the ESP32 needs to display a passkey to the user.
+// This happens when the ESP32 is display-only and a Passkey Entry pairing is negotiated.
+void onBlePasskeyNotify(const uint32_t passkey) {
+    // The link being paired, not whichever connection the server saw last
+    uint16_t connId = 0;
+    const bool known = connections.pairingCandidate(connId);
+
+    // Security check: Only allow pairing if we're in pairing mode or if no devices are bonded yet
+    if (!bondAllowlist.isEmpty() && !allowNewPairing) {
+        // This is an unauthorized pairing attempt outside of pairing mode.
+        // Force disconnect the device to prevent pairing
+        if (known) ble::disconnect(connId);
+        telemetry.count(COUNTER_REJECTED_SECURITY);
+        postBleEvent(makeBleEvent(BleEventType::PairingRejected, connId));
+        return;
+    }
+
+    // If we get here, pairing is allowed
+    BleEvent event = makeBleEvent(BleEventType::Passkey, connId);
+    event.value = passkey;
+    postBleEvent(event);
+}
+
+// This callback is triggered if a peer device explicitly requests security (e.g., to encrypt).
+bool onBleSecurityRequest() {
+    uint16_t connId = 0;
+    const bool known = connections.pairingCandidate(connId);
+    BleEvent event = makeBleEvent(BleEventType::SecurityRequest, connId);
+
+    // If we already have bonded devices, and we're not explicitly in pairing mode, reject new pairing attempts
+    if (!bondAllowlist.isEmpty() && !allowNewPairing) {
+        if (known) ble::disconnect(connId);
+        telemetry.count(COUNTER_REJECTED_SECURITY);
+        postBleEvent(event);
+        return false; // Reject the security request, preventing pairing
+    }
+    event.flags = BLE_EVENT_SUCCESS;
+    postBleEvent(event);
+    return true; // Allow the security request to initiate pairing process
+}
+
+// This callback is triggered once the entire authentication/pairing process is complete.
+void onBleAuthenticationComplete(const esp_bd_addr_t address, const esp_ble_addr_type_t type, const bool success,
+                                 const uint32_t failReason) {
+    uint16_t connId = 0;
+    const bool known = connections.findByAddress(address, connId) || connections.pairingCandidate(connId);
+    BleEvent event = makeBleEvent(BleEventType::AuthComplete, connId, address);
+    uint32_t encryptionRequestedAt = 0;
+    if (known && connections.takeEncryptionRequestedAt(connId, encryptionRequestedAt)) {
+        telemetry.record(HIST_ENCRYPT_TO_AUTH, event.timestamp - encryptionRequestedAt);
+    }
+    if (success) {
+        // Update the allowlist here so the next connect check already sees the new bond.
+        // This task is the only one adding, so nothing slips in between the check and the add.
+        // A full allowlist means the stack replaced a bond on its own; listing the bonds is
+        // too slow for this task, so loop() reloads them.
+        const bool newBond = !bondAllowlist.contains(address);
+        const bool added = bondAllowlist.add(address, type);
+        if (known) connections.authenticate(connId);
+        event.flags = BLE_EVENT_SUCCESS | (newBond ? BLE_EVENT_NEW_BOND : 0) | (added ? 0 : BLE_EVENT_RELOAD_BONDS);
+    } else {
+        event.value = failReason;
+        // It's good practice to disconnect on failed authentication to prevent unsecure connections
+        if (known) ble::disconnect(connId);
+    }
+    postBleEvent(event);
+}
+
+
+void onBleWrite(const uint16_t connId, const esp_bd_addr_t address, const uint8_t *data, const size_t length) {
+    if (length == 0) return;
+
+    BleEvent event = makeBleEvent(BleEventType::Command, connId, address);
+    if (!FrameReader::isBinary(data, length)) {
+        // Legacy text protocol: the whole write is one command such as "TRIGGER"
+        static constexpr char TRIGGER_COMMAND[] = "TRIGGER";
+        const bool isTrigger = length == sizeof(TRIGGER_COMMAND) - 1 && memcmp(data, TRIGGER_COMMAND, length) == 0;
+        event.flags = BLE_EVENT_TEXT;
+        event.command.opcode = isTrigger ? OP_TRIGGER : 0;
+        postBleEvent(event);
+        return;
+    }
+
+    // Binary protocol: any number of frames per write, each posted as its own command
+    FrameReader reader(data, length);
+    CommandView command{};
+    size_t handled = 0;
+    while (handled < MAX_COMMANDS_PER_WRITE && reader.next(command)) {
+        handled++;
+        event.flags = toRecord(command, event.command) ? 0 : BLE_EVENT_MALFORMED;
+        postBleEvent(event);
+    }
+    if (reader.malformed()) {
+        event.flags = BLE_EVENT_MALFORMED;
+        event.command = CommandRecord{0, reader.lastSeq(), 0, 0, {}};
+        postBleEvent(event);
+    }
+}
+
+void onBleSubscribe(const uint16_t connId, const BleCharacteristic characteristic, const bool notifications) {
+    connections.setSubscribed(connId, characteristic, notifications);
+}
+
+void onBleRead(const BleCharacteristic characteristic) {
+    if (characteristic == BleCharacteristic::Control) {
+        // The door status frame the loop task cached at the last transition
+        Reply reply = makeReply(0, OP_DOOR_STATUS, STATUS_OK);
+        const uint16_t status = doorStatus.load(std::memory_order_relaxed);
+        reply.data[0] = status & 0xFF;
+        reply.data[1] = status >> 8;
+        ble::setValue(characteristic, reinterpret_cast<uint8_t *>(&reply), sizeof(reply));
+    }
+}
+
+void onBleConnParamsUpdated(const esp_bd_addr_t address, const bool success, const uint32_t status,
+                            const BleConnParams &params) {
+    // The stacks report these by address, not by connection
+    uint16_t connId = 0;
+    if (!connections.findByAddress(address, connId)) return;
+    BleEvent bleEvent = makeBleEvent(BleEventType::ConnParamsUpdated, connId, address);
+    bleEvent.flags = success ? BLE_EVENT_SUCCESS : 0;
+    bleEvent.value = status;
+    bleEvent.connParams = params;
+    postBleEvent(bleEvent);
+}
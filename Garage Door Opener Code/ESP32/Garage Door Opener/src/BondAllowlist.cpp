@@ -0,0 +1,70 @@
+#include "BondAllowlist.h"
+
+#include "BleBackend.h"
+
+uint8_t BondAllowlist::load() {
+    // Listed outside the lock, the stack may allocate
+    esp_bd_addr_t listed[MAX_BONDED_DEVICES];
+    esp_ble_addr_type_t listedTypes[MAX_BONDED_DEVICES];
+    const uint8_t loaded = ble::listBonds(listed, listedTypes, MAX_BONDED_DEVICES);
+
+    // Published in one step: a lookup sees the old table or the new one, never an empty one
+    portENTER_CRITICAL(&lock);
+    memcpy(entries, listed, loaded * sizeof(esp_bd_addr_t));
+    memcpy(types, listedTypes, loaded * sizeof(esp_ble_addr_type_t));
+    count.store(loaded, std::memory_order_release);
+    removals.fetch_add(1, std::memory_order_acq_rel);
+    portEXIT_CRITICAL(&lock);
+    return loaded;
+}
+
+bool BondAllowlist::contains(const esp_bd_addr_t address) const {
+    portENTER_CRITICAL(&lock);
+    const bool found = indexOf(address) >= 0;
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool BondAllowlist::add(const esp_bd_addr_t address, const esp_ble_addr_type_t type) {
+    portENTER_CRITICAL(&lock);
+    const uint8_t n = size();
+    const bool known = indexOf(address) >= 0;
+    if (!known && n < MAX_BONDED_DEVICES) {
+        memcpy(entries[n], address, ESP_BD_ADDR_LEN);
+        types[n] = type;
+        count.store(n + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&lock);
+    return known || n < MAX_BONDED_DEVICES;
+}
+
+bool BondAllowlist::remove(const esp_bd_addr_t address) {
+    portENTER_CRITICAL(&lock);
+    const uint8_t n = size();
+    const int8_t i = indexOf(address);
+    if (i >= 0) {
+        if (i != n - 1) {
+            memcpy(entries[i], entries[n - 1], ESP_BD_ADDR_LEN);
+            types[i] = types[n - 1];
+        }
+        count.store(n - 1, std::memory_order_release);
+        removals.fetch_add(1, std::memory_order_acq_rel);
+    }
+    portEXIT_CRITICAL(&lock);
+    return i >= 0;
+}
+
+void BondAllowlist::clear() {
+    portENTER_CRITICAL(&lock);
+    count.store(0, std::memory_order_release);
+    removals.fetch_add(1, std::memory_order_acq_rel);
+    portEXIT_CRITICAL(&lock);
+}
+
+int8_t BondAllowlist::indexOf(const esp_bd_addr_t address) const {
+    const uint8_t n = size();
+    for (uint8_t i = 0; i < n; i++) {
+        if (memcmp(entries[i], address, ESP_BD_ADDR_LEN) == 0) return i;
+    }
+    return -1;
+}
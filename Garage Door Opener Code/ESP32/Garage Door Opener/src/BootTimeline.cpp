@@ -0,0 +1,16 @@
+#include "BootTimeline.h"
+
+static const char *const BOOT_PHASE_NAMES[BOOT_PHASE_COUNT] = {
+    "setup",
+    "BLE ready",
+    "GATT ready",
+    "advertising",
+    "deferred done",
+};
+
+void BootTimeline::dump(Print &out) const {
+    out.println("--- Boot timeline ---");
+    for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+        out.printf("  %-14s %8lu us\n", BOOT_PHASE_NAMES[i], static_cast<unsigned long>(stamps[i]));
+    }
+}
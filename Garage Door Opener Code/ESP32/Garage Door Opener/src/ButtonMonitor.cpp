@@ -0,0 +1,95 @@
+#include "ButtonMonitor.h"
+
+namespace {
+constexpr unsigned long DEBOUNCE_MILLIS = 15;
+constexpr unsigned long SHORT_PRESS_MAX_MILLIS = 1000;
+}
+
+ButtonMonitor::ButtonMonitor(const uint8_t pin, const unsigned long pairingHoldMillis,
+                             const unsigned long factoryResetHoldMillis)
+    : pin(pin), pairingHoldMillis(pairingHoldMillis), factoryResetHoldMillis(factoryResetHoldMillis) {}
+
+void ButtonMonitor::begin(TaskHandle_t task) {
+    wakeTask = task;
+    pinMode(pin, INPUT);
+
+    // A button already held at power up is debounced like any other edge, then treated as a reset hold
+    if (digitalRead(pin) == HIGH) {
+        bootCheck = true;
+        debouncing = true;
+        debounceStart = millis();
+    }
+    attachInterruptArg(digitalPinToInterrupt(pin), &ButtonMonitor::onEdge, this, CHANGE);
+}
+
+void IRAM_ATTR ButtonMonitor::onEdge(void *arg) {
+    auto *self = static_cast<ButtonMonitor *>(arg);
+    self->edgeMillis = millis();
+    self->edgePending = true;
+    if (self->wakeTask) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->wakeTask, &higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    }
+}
+
+ButtonEvent ButtonMonitor::poll(const unsigned long now) {
+    if (edgePending) {
+        // Every bounce restarts the debounce window
+        edgePending = false;
+        debounceStart = edgeMillis;
+        debouncing = true;
+    }
+
+    if (debouncing) {
+        if (now - debounceStart < DEBOUNCE_MILLIS) return {ButtonEventType::None, 0};
+        debouncing = false;
+
+        const bool level = digitalRead(pin) == HIGH;
+        if (level && !pressed) {
+            pressed = true;
+            pressStart = debounceStart;
+            resetHold = bootCheck;
+            holdDone = false;
+            lastSecondsReported = UINT8_MAX;
+        } else if (!level && pressed) {
+            pressed = false;
+            resetHold = false;
+            if (!holdDone) {
+                return {now - pressStart < SHORT_PRESS_MAX_MILLIS ? ButtonEventType::ShortPress
+                                                                  : ButtonEventType::HoldCancelled, 0};
+            }
+        }
+        bootCheck = false;
+    }
+
+    if (pressed && !holdDone) {
+        const unsigned long elapsed = now - pressStart;
+        if (elapsed >= holdTarget()) {
+            holdDone = true;
+            return {resetHold ? ButtonEventType::FactoryResetHold : ButtonEventType::PairingHold, 0};
+        }
+        const auto secondsRemaining = static_cast<uint8_t>((holdTarget() - elapsed) / 1000);
+        if (secondsRemaining != lastSecondsReported) {
+            lastSecondsReported = secondsRemaining;
+            return {ButtonEventType::HoldCountdown, secondsRemaining};
+        }
+    }
+
+    return {ButtonEventType::None, 0};
+}
+
+unsigned long ButtonMonitor::millisUntilNextPoll(const unsigned long now) const {
+    if (edgePending) return 0;
+    if (debouncing) {
+        const unsigned long elapsed = now - debounceStart;
+        return elapsed >= DEBOUNCE_MILLIS ? 0 : DEBOUNCE_MILLIS - elapsed;
+    }
+    if (pressed && !holdDone) {
+        const unsigned long elapsed = now - pressStart;
+        if (elapsed >= holdTarget()) return 0;
+        // Wake when the displayed second changes (or the hold completes)
+        return (holdTarget() - elapsed) % 1000 + 1;
+    }
+    return ULONG_MAX;
+}
@@ -0,0 +1,46 @@
+#include "CommandProtocol.h"
+
+#include <string.h>
+
+bool FrameReader::next(CommandView &command) {
+    if (error || offset >= length) return false;
+
+    const size_t remaining = length - offset;
+    const uint8_t *frame = data + offset;
+    if (remaining >= 3) errorSeq = frame[2];
+
+    if (remaining < FRAME_HEADER_SIZE || frame[0] != PROTOCOL_VERSION) {
+        error = true;
+        return false;
+    }
+    const uint8_t payloadLength = frame[4];
+    if (remaining < FRAME_HEADER_SIZE + payloadLength) {
+        error = true;
+        return false;
+    }
+
+    command.opcode = frame[1];
+    command.seq = frame[2];
+    command.flags = frame[3];
+    command.length = payloadLength;
+    command.payload = frame + FRAME_HEADER_SIZE;
+    offset += FRAME_HEADER_SIZE + payloadLength;
+    return true;
+}
+
+Reply makeReply(const uint8_t seq, const uint8_t opcode, const ReplyStatus status) {
+    return Reply{PROTOCOL_VERSION, seq, opcode, status, {0, 0, 0, 0}};
+}
+
+bool toRecord(const CommandView &command, CommandRecord &record) {
+    record.opcode = command.opcode;
+    record.seq = command.seq;
+    record.flags = command.flags;
+    if (command.length > MAX_COMMAND_PAYLOAD) {
+        record.length = 0;
+        return false;
+    }
+    record.length = command.length;
+    memcpy(record.payload, command.payload, command.length);
+    return true;
+}
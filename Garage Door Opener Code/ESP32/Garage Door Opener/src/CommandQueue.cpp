@@ -0,0 +1,54 @@
+#include "CommandQueue.h"
+
+bool CommandQueue::push(const BleEvent &event) {
+    Lane *lane = nullptr;
+    Lane *unused = nullptr;
+    for (Lane &candidate : lanes) {
+        if (candidate.used && candidate.connId == event.connId) {
+            lane = &candidate;
+            break;
+        }
+        if (!candidate.used && !unused) unused = &candidate;
+    }
+    if (!lane) {
+        if (!unused) return false;
+        lane = unused;
+        lane->used = true;
+        lane->connId = event.connId;
+        lane->head = 0;
+        lane->count = 0;
+    }
+    if (lane->count >= LANE_DEPTH) return false;
+
+    lane->items[(lane->head + lane->count) % LANE_DEPTH] = event;
+    lane->count++;
+    return true;
+}
+
+bool CommandQueue::pop(BleEvent &event) {
+    for (uint8_t tried = 0; tried < MAX_CONNECTIONS; tried++) {
+        Lane &lane = lanes[nextLane];
+        nextLane = (nextLane + 1) % MAX_CONNECTIONS;
+        if (!lane.used) continue;
+
+        event = lane.items[lane.head];
+        lane.head = (lane.head + 1) % LANE_DEPTH;
+        if (--lane.count == 0) lane.used = false; // Frees the lane for the next connection
+        return true;
+    }
+    return false;
+}
+
+void CommandQueue::drop(const uint16_t connId) {
+    for (Lane &lane : lanes) {
+        if (lane.used && lane.connId == connId) lane.used = false;
+    }
+}
+
+size_t CommandQueue::size() const {
+    size_t total = 0;
+    for (const Lane &lane : lanes) {
+        if (lane.used) total += lane.count;
+    }
+    return total;
+}
@@ -0,0 +1,186 @@
+#include "ConnParamManager.h"
+
+#include <Preferences.h>
+
+#include "BleBackend.h"
+#include "Config.h"
+
+static constexpr const char *PROFILE_NAMESPACE = "connprof";
+static constexpr uint8_t PROFILE_KINDS = static_cast<uint8_t>(ConnProfileKind::Count);
+
+static Preferences profileStore;
+
+// NVS keys are limited to 15 characters; the address in hex takes 12
+static void profileKey(const esp_bd_addr_t address, char (&key)[ESP_BD_ADDR_LEN * 2 + 1]) {
+    snprintf(key, sizeof(key), "%02x%02x%02x%02x%02x%02x",
+             address[0], address[1], address[2], address[3], address[4], address[5]);
+}
+
+static void defaultProfiles(ConnProfile *profiles) {
+    profiles[static_cast<uint8_t>(ConnProfileKind::Fast)] = DEFAULT_FAST_PROFILE;
+    profiles[static_cast<uint8_t>(ConnProfileKind::Idle)] = DEFAULT_IDLE_PROFILE;
+}
+
+// Reads the overrides of one device, the defaults where there are none
+static void readProfiles(const esp_bd_addr_t address, ConnProfile *profiles) {
+    defaultProfiles(profiles);
+    char key[ESP_BD_ADDR_LEN * 2 + 1];
+    profileKey(address, key);
+    if (!profileStore.begin(PROFILE_NAMESPACE, true)) return;
+    ConnProfile stored[PROFILE_KINDS];
+    if (profileStore.getBytes(key, stored, sizeof(stored)) == sizeof(stored)) {
+        for (uint8_t i = 0; i < PROFILE_KINDS; i++) {
+            if (ConnParamManager::isValid(stored[i])) profiles[i] = stored[i];
+        }
+    }
+    profileStore.end();
+}
+
+// Writes the overrides of one device; a device back on both defaults loses its entry
+static void storeProfiles(const esp_bd_addr_t address, const ConnProfile *profiles) {
+    char key[ESP_BD_ADDR_LEN * 2 + 1];
+    profileKey(address, key);
+    if (!profileStore.begin(PROFILE_NAMESPACE, false)) return;
+    const bool defaults = memcmp(&profiles[static_cast<uint8_t>(ConnProfileKind::Fast)], &DEFAULT_FAST_PROFILE, sizeof(ConnProfile)) == 0 &&
+                          memcmp(&profiles[static_cast<uint8_t>(ConnProfileKind::Idle)], &DEFAULT_IDLE_PROFILE, sizeof(ConnProfile)) == 0;
+    if (defaults) {
+        profileStore.remove(key);
+    } else {
+        profileStore.putBytes(key, profiles, sizeof(ConnProfile) * PROFILE_KINDS);
+    }
+    profileStore.end();
+}
+
+bool ConnParamManager::isValid(const ConnProfile &profile) {
+    if (profile.minInterval < 6 || profile.maxInterval > 3200 || profile.minInterval > profile.maxInterval) return false;
+    if (profile.latency > 499 || profile.timeout < 10 || profile.timeout > 3200) return false;
+    // The supervision timeout has to outlast two of the longest gaps between listened events:
+    // timeout * 10 ms > (1 + latency) * maxInterval * 1.25 ms * 2
+    return static_cast<uint32_t>(profile.timeout) * 4 > (1UL + profile.latency) * profile.maxInterval;
+}
+
+ConnParamManager::Link *ConnParamManager::linkFor(const uint16_t connId) {
+    for (Link &link : links) {
+        if (link.used && link.connId == connId) return &link;
+    }
+    return nullptr;
+}
+
+const ConnParamManager::Link *ConnParamManager::linkFor(const uint16_t connId) const {
+    for (const Link &link : links) {
+        if (link.used && link.connId == connId) return &link;
+    }
+    return nullptr;
+}
+
+void ConnParamManager::request(Link &link, const ConnProfileKind kind) {
+    const ConnProfile &profile = link.profiles[static_cast<uint8_t>(kind)];
+    ble::updateConnParams(link.connId, link.address, profile.minInterval, profile.maxInterval, profile.latency,
+                          profile.timeout);
+    link.kind = kind;
+}
+
+void ConnParamManager::onAuthenticated(const uint16_t connId, const esp_bd_addr_t address, const unsigned long now) {
+    Link *link = linkFor(connId);
+    if (!link) {
+        for (Link &candidate : links) {
+            if (!candidate.used) {
+                link = &candidate;
+                break;
+            }
+        }
+        if (!link) return;
+    }
+    *link = {};
+    link->used = true;
+    link->connId = connId;
+    memcpy(link->address, address, ESP_BD_ADDR_LEN);
+    link->lastActivity = now;
+    readProfiles(link->address, link->profiles);
+    request(*link, ConnProfileKind::Fast);
+}
+
+void ConnParamManager::onActivity(const uint16_t connId, const unsigned long now) {
+    Link *link = linkFor(connId);
+    if (!link) return;
+    link->lastActivity = now;
+    if (link->kind != ConnProfileKind::Fast) request(*link, ConnProfileKind::Fast);
+}
+
+void ConnParamManager::onDisconnected(const uint16_t connId) {
+    Link *link = linkFor(connId);
+    if (link) link->used = false;
+}
+
+void ConnParamManager::onNegotiated(const uint16_t connId, const BleConnParams &params) {
+    Link *link = linkFor(connId);
+    if (link) link->negotiated = params;
+}
+
+void ConnParamManager::idleDue(const unsigned long now) {
+    for (Link &link : links) {
+        if (!link.used || link.kind != ConnProfileKind::Fast) continue;
+        if (now - link.lastActivity >= CONN_IDLE_AFTER_MILLIS) request(link, ConnProfileKind::Idle);
+    }
+}
+
+unsigned long ConnParamManager::millisUntilIdle(const unsigned long now) const {
+    unsigned long next = ULONG_MAX;
+    for (const Link &link : links) {
+        if (!link.used || link.kind != ConnProfileKind::Fast) continue;
+        const unsigned long elapsed = now - link.lastActivity;
+        const unsigned long remaining = elapsed >= CONN_IDLE_AFTER_MILLIS ? 0 : CONN_IDLE_AFTER_MILLIS - elapsed;
+        if (remaining < next) next = remaining;
+    }
+    return next;
+}
+
+bool ConnParamManager::setProfile(const esp_bd_addr_t address, const ConnProfileKind kind, const ConnProfile &profile) {
+    if (kind >= ConnProfileKind::Count || !isValid(profile)) return false;
+
+    ConnProfile profiles[PROFILE_KINDS];
+    readProfiles(address, profiles);
+    profiles[static_cast<uint8_t>(kind)] = profile;
+    storeProfiles(address, profiles);
+
+    for (Link &link : links) {
+        if (!link.used || memcmp(link.address, address, ESP_BD_ADDR_LEN) != 0) continue;
+        link.profiles[static_cast<uint8_t>(kind)] = profile;
+        if (link.kind == kind) request(link, kind);
+    }
+    return true;
+}
+
+void ConnParamManager::resetProfile(const esp_bd_addr_t address, const ConnProfileKind kind) {
+    if (kind >= ConnProfileKind::Count) return;
+    const ConnProfile profile = kind == ConnProfileKind::Fast ? DEFAULT_FAST_PROFILE : DEFAULT_IDLE_PROFILE;
+    setProfile(address, kind, profile);
+}
+
+void ConnParamManager::forgetProfiles(const esp_bd_addr_t address) {
+    char key[ESP_BD_ADDR_LEN * 2 + 1];
+    profileKey(address, key);
+    if (!profileStore.begin(PROFILE_NAMESPACE, false)) return;
+    profileStore.remove(key);
+    profileStore.end();
+}
+
+void ConnParamManager::clearProfiles() {
+    if (!profileStore.begin(PROFILE_NAMESPACE, false)) return;
+    profileStore.clear();
+    profileStore.end();
+}
+
+bool ConnParamManager::negotiated(const uint16_t connId, BleConnParams &params) const {
+    const Link *link = linkFor(connId);
+    if (!link) return false;
+    params = link->negotiated;
+    return true;
+}
+
+bool ConnParamManager::currentProfile(const uint16_t connId, ConnProfileKind &kind) const {
+    const Link *link = linkFor(connId);
+    if (!link) return false;
+    kind = link->kind;
+    return true;
+}
@@ -0,0 +1,151 @@
+#include "ConnectionTable.h"
+
+bool ConnectionTable::add(const uint16_t connId, const esp_bd_addr_t address, const uint32_t now) {
+    bool added = false;
+    portENTER_CRITICAL(&lock);
+    Connection *slot = slotFor(connId);
+    for (uint8_t i = 0; !slot && i < MAX_CONNECTIONS; i++) {
+        if (entries[i].state == LinkState::Free) slot = &entries[i];
+    }
+    if (slot) {
+        slot->connId = connId;
+        slot->state = LinkState::Connected;
+        memcpy(slot->address, address, ESP_BD_ADDR_LEN);
+        slot->connectedAt = now;
+        slot->encryptionRequestedAt = 0;
+        slot->subscriptions = 0;
+        added = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    return added;
+}
+
+void ConnectionTable::remove(const uint16_t connId) {
+    portENTER_CRITICAL(&lock);
+    if (Connection *slot = slotFor(connId)) slot->state = LinkState::Free;
+    portEXIT_CRITICAL(&lock);
+}
+
+void ConnectionTable::authenticate(const uint16_t connId) {
+    portENTER_CRITICAL(&lock);
+    if (Connection *slot = slotFor(connId)) slot->state = LinkState::Authenticated;
+    portEXIT_CRITICAL(&lock);
+}
+
+void ConnectionTable::encryptionRequested(const uint16_t connId, const uint32_t now) {
+    portENTER_CRITICAL(&lock);
+    if (Connection *slot = slotFor(connId)) slot->encryptionRequestedAt = now;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool ConnectionTable::takeEncryptionRequestedAt(const uint16_t connId, uint32_t &requestedAt) {
+    bool taken = false;
+    portENTER_CRITICAL(&lock);
+    Connection *slot = slotFor(connId);
+    if (slot && slot->encryptionRequestedAt != 0) {
+        requestedAt = slot->encryptionRequestedAt;
+        slot->encryptionRequestedAt = 0;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&lock);
+    return taken;
+}
+
+void ConnectionTable::setSubscribed(const uint16_t connId, const BleCharacteristic characteristic,
+                                    const bool subscribed) {
+    const uint8_t bit = 1 << static_cast<uint8_t>(characteristic);
+    portENTER_CRITICAL(&lock);
+    if (Connection *slot = slotFor(connId)) {
+        slot->subscriptions = subscribed ? slot->subscriptions | bit : slot->subscriptions & ~bit;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+bool ConnectionTable::isSubscribed(const uint16_t connId, const BleCharacteristic characteristic) const {
+    portENTER_CRITICAL(&lock);
+    const Connection *slot = slotFor(connId);
+    const bool subscribed = slot && (slot->subscriptions & (1 << static_cast<uint8_t>(characteristic)));
+    portEXIT_CRITICAL(&lock);
+    return subscribed;
+}
+
+bool ConnectionTable::find(const uint16_t connId, Connection &connection) const {
+    portENTER_CRITICAL(&lock);
+    const Connection *slot = slotFor(connId);
+    if (slot) connection = *slot;
+    portEXIT_CRITICAL(&lock);
+    return slot != nullptr;
+}
+
+bool ConnectionTable::findByAddress(const esp_bd_addr_t address, uint16_t &connId) const {
+    bool found = false;
+    portENTER_CRITICAL(&lock);
+    for (const Connection &entry : entries) {
+        if (entry.state == LinkState::Free || memcmp(entry.address, address, ESP_BD_ADDR_LEN) != 0) continue;
+        connId = entry.connId;
+        found = true;
+        break;
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+bool ConnectionTable::isAuthenticated(const uint16_t connId) const {
+    portENTER_CRITICAL(&lock);
+    const Connection *slot = slotFor(connId);
+    const bool authenticated = slot && slot->state == LinkState::Authenticated;
+    portEXIT_CRITICAL(&lock);
+    return authenticated;
+}
+
+bool ConnectionTable::pairingCandidate(uint16_t &connId) const {
+    const Connection *newest = nullptr;
+    portENTER_CRITICAL(&lock);
+    for (const Connection &entry : entries) {
+        if (entry.state != LinkState::Connected) continue;
+        if (!newest || static_cast<int32_t>(entry.connectedAt - newest->connectedAt) > 0) newest = &entry;
+    }
+    if (newest) connId = newest->connId;
+    portEXIT_CRITICAL(&lock);
+    return newest != nullptr;
+}
+
+uint8_t ConnectionTable::authenticated(uint16_t (&connIds)[MAX_CONNECTIONS]) const {
+    uint8_t found = 0;
+    portENTER_CRITICAL(&lock);
+    for (const Connection &entry : entries) {
+        if (entry.state == LinkState::Authenticated) connIds[found++] = entry.connId;
+    }
+    portEXIT_CRITICAL(&lock);
+    return found;
+}
+
+uint8_t ConnectionTable::count() const {
+    uint8_t live = 0;
+    portENTER_CRITICAL(&lock);
+    for (const Connection &entry : entries) {
+        if (entry.state != LinkState::Free) live++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return live;
+}
+
+void ConnectionTable::clear() {
+    portENTER_CRITICAL(&lock);
+    for (Connection &entry : entries) entry.state = LinkState::Free;
+    portEXIT_CRITICAL(&lock);
+}
+
+Connection *ConnectionTable::slotFor(const uint16_t connId) {
+    for (Connection &entry : entries) {
+        if (entry.state != LinkState::Free && entry.connId == connId) return &entry;
+    }
+    return nullptr;
+}
+
+const Connection *ConnectionTable::slotFor(const uint16_t connId) const {
+    for (const Connection &entry : entries) {
+        if (entry.state != LinkState::Free && entry.connId == connId) return &entry;
+    }
+    return nullptr;
+}
@@ -0,0 +1,193 @@
+#include "DeviceRegistry.h"
+
+#include <Preferences.h>
+
+static constexpr const char *REGISTRY_NAMESPACE = "devices";
+static constexpr const char *REGISTRY_KEY = "registry";
+static constexpr uint8_t REGISTRY_VERSION = 1;
+
+// Blob layout: this header, then `count` DeviceRecords
+struct __attribute__((packed)) RegistryHeader {
+    uint8_t version;
+    uint8_t count;
+    uint32_t tick;
+};
+
+static Preferences registryStore;
+static uint8_t blob[sizeof(RegistryHeader) + sizeof(DeviceRecord) * MAX_BONDED_DEVICES];
+
+// FNV-1a over the six address bytes; the low bits pick the index slot
+uint8_t DeviceRegistry::hash(const esp_bd_addr_t address) {
+    uint32_t value = 2166136261u;
+    for (uint8_t i = 0; i < ESP_BD_ADDR_LEN; i++) {
+        value ^= address[i];
+        value *= 16777619u;
+    }
+    return value & (INDEX_SLOTS - 1);
+}
+
+int8_t DeviceRegistry::indexOf(const esp_bd_addr_t address) const {
+    // The index is never more than half full, so a free slot always ends the probe
+    for (uint8_t slot = hash(address);; slot = (slot + 1) & (INDEX_SLOTS - 1)) {
+        const int8_t position = index[slot];
+        if (position == NO_RECORD) return NO_RECORD;
+        if (memcmp(records[position].address, address, ESP_BD_ADDR_LEN) == 0) return position;
+    }
+}
+
+void DeviceRegistry::rebuildIndex() {
+    memset(index, NO_RECORD, sizeof(index));
+    for (uint8_t position = 0; position < count; position++) {
+        uint8_t slot = hash(records[position].address);
+        while (index[slot] != NO_RECORD) slot = (slot + 1) & (INDEX_SLOTS - 1);
+        index[slot] = static_cast<int8_t>(position);
+    }
+}
+
+DeviceRecord *DeviceRegistry::add(const esp_bd_addr_t address) {
+    if (count >= MAX_BONDED_DEVICES) return nullptr;
+    DeviceRecord &record = records[count];
+    record = {};
+    memcpy(record.address, address, ESP_BD_ADDR_LEN);
+    uint8_t slot = hash(address);
+    while (index[slot] != NO_RECORD) slot = (slot + 1) & (INDEX_SLOTS - 1);
+    index[slot] = static_cast<int8_t>(count++);
+    dirty = true;
+    return &record;
+}
+
+void DeviceRegistry::load(const BondAllowlist &bonds) {
+    count = 0;
+    tick = 0;
+    dirty = false;
+
+    size_t length = 0;
+    if (registryStore.begin(REGISTRY_NAMESPACE, true)) {
+        length = registryStore.getBytes(REGISTRY_KEY, blob, sizeof(blob));
+        registryStore.end();
+    }
+    RegistryHeader header{};
+    if (length >= sizeof(header)) memcpy(&header, blob, sizeof(header));
+    const bool valid = length >= sizeof(header) && header.version == REGISTRY_VERSION &&
+                       header.count <= MAX_BONDED_DEVICES &&
+                       length == sizeof(header) + header.count * sizeof(DeviceRecord);
+    if (valid) {
+        tick = header.tick;
+        // Records of bonds removed behind our back (e.g. the old full NVS clear) are dropped
+        for (uint8_t i = 0; i < header.count; i++) {
+            DeviceRecord record;
+            memcpy(&record, blob + sizeof(header) + i * sizeof(DeviceRecord), sizeof(record));
+            if (bonds.contains(record.address)) {
+                records[count++] = record;
+            } else {
+                dirty = true;
+            }
+        }
+    }
+    rebuildIndex();
+
+    // Bonds made before the registry existed start out as never seen, first in line for eviction
+    for (uint8_t i = 0; i < bonds.size(); i++) {
+        if (indexOf(bonds.addressAt(i)) == NO_RECORD) add(bonds.addressAt(i));
+    }
+}
+
+bool DeviceRegistry::save() {
+    if (!dirty) return true;
+    const RegistryHeader header = {REGISTRY_VERSION, count, tick};
+    memcpy(blob, &header, sizeof(header));
+    memcpy(blob + sizeof(header), records, count * sizeof(DeviceRecord));
+    const size_t length = sizeof(header) + count * sizeof(DeviceRecord);
+
+    if (!registryStore.begin(REGISTRY_NAMESPACE, false)) return false;
+    const bool written = registryStore.putBytes(REGISTRY_KEY, blob, length) == length;
+    registryStore.end();
+    if (!written) return false;
+    dirty = false;
+    writes++;
+    return true;
+}
+
+void DeviceRegistry::clear() {
+    count = 0;
+    tick = 0;
+    dirty = false;
+    rebuildIndex();
+    if (!registryStore.begin(REGISTRY_NAMESPACE, false)) return;
+    registryStore.clear();
+    registryStore.end();
+}
+
+const DeviceRecord *DeviceRegistry::find(const esp_bd_addr_t address) const {
+    const int8_t position = indexOf(address);
+    return position == NO_RECORD ? nullptr : &records[position];
+}
+
+bool DeviceRegistry::touch(const esp_bd_addr_t address) {
+    const int8_t position = indexOf(address);
+    DeviceRecord *record = position == NO_RECORD ? add(address) : &records[position];
+    if (!record) return false;
+    record->lastSeen = ++tick;
+    dirty = true;
+    return true;
+}
+
+void DeviceRegistry::countTrigger(const esp_bd_addr_t address) {
+    const int8_t position = indexOf(address);
+    if (position == NO_RECORD) return;
+    records[position].triggerCount++;
+    dirty = true;
+}
+
+bool DeviceRegistry::setName(const esp_bd_addr_t address, const uint8_t *name, const size_t length) {
+    const int8_t position = indexOf(address);
+    if (position == NO_RECORD) return false;
+    DeviceRecord &record = records[position];
+    memset(record.name, 0, sizeof(record.name));
+    memcpy(record.name, name, length < sizeof(record.name) ? length : sizeof(record.name));
+    dirty = true;
+    return true;
+}
+
+bool DeviceRegistry::remove(const esp_bd_addr_t address) {
+    const int8_t position = indexOf(address);
+    if (position == NO_RECORD) return false;
+    // Swap the last record into the gap; with open addressing a fresh index is simpler than
+    // patching probe chains, and revocation is rare
+    records[position] = records[--count];
+    rebuildIndex();
+    dirty = true;
+    return true;
+}
+
+const DeviceRecord *DeviceRegistry::leastRecentlySeen(const ConnectionTable &connections) const {
+    const DeviceRecord *oldest = nullptr;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t connId = 0;
+        if (connections.findByAddress(records[i].address, connId)) continue;
+        if (!oldest || records[i].lastSeen < oldest->lastSeen) oldest = &records[i];
+    }
+    return oldest;
+}
+
+size_t DeviceRegistry::serialize(uint8_t *out, const size_t capacity) const {
+    const size_t length = count * sizeof(DeviceRecord);
+    if (capacity < length) return 0;
+    memcpy(out, records, length);
+    return length;
+}
+
+void DeviceRegistry::dump(Print &out) const {
+    out.println("\n--- Devices ---");
+    for (uint8_t i = 0; i < count; i++) {
+        const DeviceRecord &record = records[i];
+        char name[DEVICE_NAME_LEN + 1] = {};
+        memcpy(name, record.name, DEVICE_NAME_LEN);
+        out.printf("  %02X:%02X:%02X:%02X:%02X:%02X  %-8s seen %lu  triggers %lu\n",
+                   record.address[0], record.address[1], record.address[2],
+                   record.address[3], record.address[4], record.address[5], name,
+                   static_cast<unsigned long>(record.lastSeen), static_cast<unsigned long>(record.triggerCount));
+    }
+    out.printf("  tick %lu, %lu writes\n", static_cast<unsigned long>(tick), static_cast<unsigned long>(writes));
+    out.println("--- End of Devices ---");
+}
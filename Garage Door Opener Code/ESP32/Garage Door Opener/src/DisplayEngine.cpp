@@ -0,0 +1,94 @@
+#include "DisplayEngine.h"
+
+uint8_t DisplayEngine::show(const DisplayLayer layer, const uint8_t (&segments)[MAX7219_DIGITS],
+                            const unsigned long holdMillis, const unsigned long now) {
+    Layer &target = layers[static_cast<uint8_t>(layer)];
+    target = {};
+    target.active = true;
+    target.expires = holdMillis > 0;
+    target.expiresAt = now + holdMillis;
+    memcpy(target.segments, segments, MAX7219_DIGITS);
+    return render();
+}
+
+void DisplayEngine::play(const DisplayLayer layer, const Animation &animation, const unsigned long holdMillis,
+                         const unsigned long now) {
+    if (animation.frameCount == 0) return;
+    Layer &target = layers[static_cast<uint8_t>(layer)];
+    target = {};
+    target.active = true;
+    target.animation = &animation;
+    target.frameStartedAt = now;
+    target.expires = holdMillis > 0;
+    target.expiresAt = now + holdMillis;
+    memcpy(target.segments, animation.frames[0].segments, MAX7219_DIGITS);
+    render();
+}
+
+void DisplayEngine::clear(const DisplayLayer layer) {
+    layers[static_cast<uint8_t>(layer)].active = false;
+    render();
+}
+
+bool DisplayEngine::isActive(const DisplayLayer layer) const {
+    return layers[static_cast<uint8_t>(layer)].active;
+}
+
+bool DisplayEngine::isPlaying(const DisplayLayer layer, const Animation &animation) const {
+    const Layer &target = layers[static_cast<uint8_t>(layer)];
+    return target.active && target.animation == &animation;
+}
+
+void DisplayEngine::tick(const unsigned long now) {
+    for (Layer &layer : layers) {
+        if (!layer.active) continue;
+        if (layer.expires && static_cast<long>(now - layer.expiresAt) >= 0) {
+            layer.active = false;
+            continue;
+        }
+        if (!layer.animation) continue;
+
+        // Catch up on every frame that is due, e.g. after loop() was held up
+        const Animation &animation = *layer.animation;
+        while (now - layer.frameStartedAt >= animation.frames[layer.frame].durationMillis) {
+            layer.frameStartedAt += animation.frames[layer.frame].durationMillis;
+            if (++layer.frame >= animation.frameCount) {
+                if (!animation.loop) {
+                    layer.active = false;
+                    break;
+                }
+                layer.frame = 0;
+            }
+        }
+        if (layer.active) memcpy(layer.segments, animation.frames[layer.frame].segments, MAX7219_DIGITS);
+    }
+    render();
+}
+
+unsigned long DisplayEngine::millisUntilTick(const unsigned long now) const {
+    unsigned long next = ULONG_MAX;
+    for (const Layer &layer : layers) {
+        if (!layer.active) continue;
+        if (layer.expires) {
+            const unsigned long remaining = static_cast<long>(layer.expiresAt - now) > 0 ? layer.expiresAt - now : 0;
+            if (remaining < next) next = remaining;
+        }
+        if (layer.animation) {
+            const unsigned long elapsed = now - layer.frameStartedAt;
+            const unsigned long duration = layer.animation->frames[layer.frame].durationMillis;
+            const unsigned long remaining = elapsed >= duration ? 0 : duration - elapsed;
+            if (remaining < next) next = remaining;
+        }
+    }
+    return next;
+}
+
+uint8_t DisplayEngine::render() {
+    for (int8_t i = static_cast<int8_t>(DisplayLayer::Count) - 1; i >= 0; i--) {
+        if (!layers[i].active) continue;
+        for (uint8_t digit = 0; digit < MAX7219_DIGITS; digit++) display.setSegments(digit, layers[i].segments[digit]);
+        return display.flush();
+    }
+    display.clear();
+    return display.flush();
+}
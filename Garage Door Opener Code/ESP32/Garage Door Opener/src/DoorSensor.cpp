@@ -0,0 +1,114 @@
+#include "DoorSensor.h"
+
+namespace {
+// Reed switches chatter as the magnet passes and the door shakes at the end of its run
+constexpr unsigned long DEBOUNCE_MILLIS = 50;
+}
+
+DoorSensor::DoorSensor(const int8_t closedPin, const int8_t openPin, const unsigned long travelMillis)
+    : closed{closedPin, this, false, 0, false, 0, false},
+      open{closedPin >= 0 ? openPin : static_cast<int8_t>(-1), this, false, 0, false, 0, false},
+      travelMillis(travelMillis) {}
+
+void DoorSensor::setup(Input &input) {
+    input.edgePending = false;
+    input.debouncing = false;
+    if (input.pin < 0) return;
+    pinMode(input.pin, INPUT_PULLUP);
+    input.active = digitalRead(input.pin) == LOW;
+    attachInterruptArg(digitalPinToInterrupt(input.pin), &DoorSensor::onEdge, &input, CHANGE);
+}
+
+void DoorSensor::begin(TaskHandle_t task, const unsigned long now) {
+    wakeTask = task;
+    travelling = false;
+    pulseAtLimit = false;
+    setup(closed);
+    setup(open);
+    current = evaluate(now);
+}
+
+void IRAM_ATTR DoorSensor::onEdge(void *arg) {
+    auto *input = static_cast<Input *>(arg);
+    input->edgeMillis = millis();
+    input->edgePending = true;
+    if (input->owner->wakeTask) {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(input->owner->wakeTask, &higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+    }
+}
+
+void DoorSensor::onPulse(const unsigned long now) {
+    if (!isFitted()) return;
+    travelling = true;
+    pulseAtLimit = closed.active || open.active;
+    travelStart = now;
+}
+
+bool DoorSensor::debounce(Input &input, const unsigned long now) {
+    if (input.pin < 0) return false;
+    if (input.edgePending) {
+        // Every bounce restarts the debounce window
+        input.edgePending = false;
+        input.debounceStart = input.edgeMillis;
+        input.debouncing = true;
+    }
+    if (!input.debouncing || now - input.debounceStart < DEBOUNCE_MILLIS) return false;
+    input.debouncing = false;
+
+    const bool active = digitalRead(input.pin) == LOW;
+    if (active == input.active) return false;
+    input.active = active;
+    if (active) {
+        travelling = false; // Arrived
+        pulseAtLimit = false;
+    } else {
+        travelling = true; // Left a limit, the run starts at the first edge
+        pulseAtLimit = false;
+        travelStart = input.debounceStart;
+    }
+    return true;
+}
+
+DoorState DoorSensor::evaluate(const unsigned long now) const {
+    if (!isFitted()) return DoorState::Unknown;
+    if (closed.active && open.active) return DoorState::Fault;
+    if (closed.active || open.active) {
+        if (travelling && pulseAtLimit && travelExpired(now)) return DoorState::Fault; // Never left
+        return closed.active ? DoorState::Closed : DoorState::Open;
+    }
+    const bool twoSwitches = open.pin >= 0;
+    if (!travelling) return twoSwitches ? DoorState::Unknown : DoorState::Open;
+    if (!travelExpired(now)) return DoorState::Moving;
+    return twoSwitches ? DoorState::Fault : DoorState::Open;
+}
+
+bool DoorSensor::poll(const unsigned long now) {
+    debounce(closed, now);
+    debounce(open, now);
+    const DoorState next = evaluate(now);
+    if (next == current) return false;
+    current = next;
+    transitionCount++;
+    return true;
+}
+
+unsigned long DoorSensor::millisUntilNextPoll(const unsigned long now) const {
+    unsigned long next = ULONG_MAX;
+    for (const Input *input : {&closed, &open}) {
+        if (input->pin < 0) continue;
+        if (input->edgePending) return 0;
+        if (!input->debouncing) continue;
+        const unsigned long elapsed = now - input->debounceStart;
+        const unsigned long remaining = elapsed >= DEBOUNCE_MILLIS ? 0 : DEBOUNCE_MILLIS - elapsed;
+        if (remaining < next) next = remaining;
+    }
+    // Only a timeout that can still change the state needs a wake up
+    const bool atLimit = closed.active || open.active;
+    if (travelling && (!atLimit || pulseAtLimit) && !travelExpired(now)) {
+        const unsigned long remaining = travelMillis - (now - travelStart);
+        if (remaining < next) next = remaining;
+    }
+    return next;
+}
@@ -0,0 +1,739 @@
+#include "EventHandlers.h"
+
+#include "esp_heap_caps.h"
+
+#include "AdvertisingPolicy.h"
+#include "AppState.h"
+#include "BleBackend.h"
+#include "StatusDisplay.h"
+
+// A connection waiting to hear how the running relay pulse goes
+struct TriggerWaiter {
+    uint16_t connId;
+    uint8_t seq;
+    bool binary; // Reply frames instead of text
+};
+
+// Every trigger that started or was coalesced into the running pulse, at most one per connection
+static TriggerWaiter triggerWaiters[MAX_CONNECTIONS];
+static uint8_t triggerWaiterCount = 0;
+
+// Audit log download in progress, one connection at a time
+struct AuditStream {
+    bool active;
+    uint16_t connId;
+    uint32_t nextSequence;
+    uint32_t endSequence; // Records appended after the request are not part of it
+};
+static AuditStream auditStream{};
+
+// Door state the clients last heard about
+static DoorState notifiedDoorState = DoorState::Unknown;
+
+static uint32_t heapBlocksAtBoot = 0;
+
+// Queues a door event and makes sure it reaches flash within AUDIT_FLUSH_MILLIS
+static void audit(const AuditEvent event, const uint8_t *address) {
+    auditLog.append(event, address, millis());
+    if (!auditLog.hasUnsaved()) {
+        scheduler.cancel(TIMER_AUDIT_FLUSH); // The batch filled up and was written
+    } else if (!scheduler.isScheduled(TIMER_AUDIT_FLUSH)) {
+        scheduler.schedule(TIMER_AUDIT_FLUSH, AUDIT_FLUSH_MILLIS);
+    }
+}
+
+// Publishes a registry change within REGISTRY_PUBLISH_MILLIS and saves it within REGISTRY_SAVE_MILLIS.
+// Cheap enough for the trigger path: a burst of triggers costs one serialization.
+void registryChanged() {
+    if (!scheduler.isScheduled(TIMER_REGISTRY_PUBLISH)) {
+        scheduler.schedule(TIMER_REGISTRY_PUBLISH, REGISTRY_PUBLISH_MILLIS);
+    }
+    if (deviceRegistry.isDirty() && !scheduler.isScheduled(TIMER_REGISTRY_SAVE)) {
+        scheduler.schedule(TIMER_REGISTRY_SAVE, REGISTRY_SAVE_MILLIS);
+    }
+}
+
+// TIMER_REGISTRY_PUBLISH handler: the registry records on the devices characteristic
+void registryPublish() {
+    static uint8_t value[sizeof(DeviceRecord) * MAX_BONDED_DEVICES];
+    const size_t length = deviceRegistry.serialize(value, sizeof(value));
+    ble::setValue(BleCharacteristic::Devices, value, length);
+}
+
+// TIMER_STATS_REFRESH handler: the telemetry blob on the stats characteristic. Built here, as
+// most gauges belong to the loop task and the heap walk is no work for the BLE task; reads
+// return the last blob. Repeats while a link is up, the next connect starts it again.
+void statsRefresh() {
+    static uint8_t blob[Telemetry::serializedSize()];
+    refreshTelemetryGauges();
+    const size_t length = telemetry.serialize(blob, sizeof(blob));
+    ble::setValue(BleCharacteristic::Stats, blob, length);
+    if (connections.count() > 0) scheduler.schedule(TIMER_STATS_REFRESH, STATS_REFRESH_MILLIS);
+}
+
+// TIMER_REGISTRY_SAVE handler
+void registrySave() {
+    if (deviceRegistry.save()) return;
+    LOG_WARN(LOG_REGISTRY_SAVE_FAILED);
+    scheduler.schedule(TIMER_REGISTRY_SAVE, REGISTRY_SAVE_MILLIS);
+}
+
+// Peer address of a connection, nullptr once it is gone
+static const uint8_t *peerAddress(const uint16_t connId, Connection &connection) {
+    return connections.find(connId, connection) ? connection.address : nullptr;
+}
+
+// TIMER_AUDIT_FLUSH handler
+void auditFlush() {
+    auditLog.flush();
+}
+
+// TIMER_AUDIT_STREAM handler: sends the next few chunks of a download
+void auditStreamStep() {
+    if (!auditStream.active) return;
+
+    static AuditRecord chunk[(AUDIT_LOCAL_MTU - 3) / sizeof(AuditRecord)];
+    const uint16_t mtu = ble::peerMtu(auditStream.connId);
+    size_t perChunk = mtu > 3 ? (mtu - 3) / sizeof(AuditRecord) : 0;
+    if (perChunk == 0) perChunk = 1; // A 23 byte MTU still carries one record
+    if (perChunk > sizeof(chunk) / sizeof(AuditRecord)) perChunk = sizeof(chunk) / sizeof(AuditRecord);
+
+    for (uint8_t i = 0; i < AUDIT_STREAM_CHUNKS_PER_STEP; i++) {
+        // Records the ring overwrote since the request are skipped
+        const uint32_t from = auditStream.nextSequence > auditLog.oldestSequence() ? auditStream.nextSequence
+                                                                                    : auditLog.oldestSequence();
+        if (from >= auditStream.endSequence) break;
+        const uint32_t wanted = auditStream.endSequence - from;
+        const size_t count = auditLog.read(from, chunk, wanted < perChunk ? wanted : perChunk);
+        if (count == 0) break;
+        const bool sent = ble::notify(BleCharacteristic::Audit, auditStream.connId,
+                                      reinterpret_cast<const uint8_t *>(chunk), count * sizeof(AuditRecord));
+        if (!sent) break; // Out of stack buffers, try again on the next step
+        auditStream.nextSequence = from + count;
+    }
+
+    if (auditStream.nextSequence >= auditStream.endSequence) {
+        auditStream.active = false;
+    } else {
+        scheduler.schedule(TIMER_AUDIT_STREAM, AUDIT_STREAM_STEP_MILLIS);
+    }
+}
+
+// Add this function to your code
+void clearBondedDevices() {
+    LOG_INFO(LOG_BONDS_CLEARING);
+    audit(AuditEvent::FactoryReset, nullptr);
+    ble::clearBonds();
+    bondAllowlist.clear();
+    connParams.clearProfiles();
+    deviceRegistry.clear();
+
+    LOG_WARN(LOG_BONDS_CLEARED);
+    auditLog.flush();     // The audit partition is kept, the batch in RAM would not be
+    logger.flush(Serial); // The log task dies with the restart
+    ESP.restart();
+}
+
+// Function to list all currently bonded devices, read from the in-RAM allowlist
+void listBondedDevices() {
+    const uint8_t dev_num = bondAllowlist.size();
+    LOG_INFO(LOG_BOND_COUNT, dev_num);
+    for (int i = 0; i < dev_num; i++) {
+        // Print the MAC address of each bonded device
+        LOG_INFO_ADDR(LOG_BOND_ENTRY, bondAllowlist.addressAt(i));
+    }
+}
+
+
+// Keeps advertising up while there is room for another peer and someone who may connect
+static void advertiseIfRoom() {
+    if (connections.isFull() || (bondAllowlist.isEmpty() && !pairingModeActive)) {
+        stopAdvertising();
+        return;
+    }
+    startAdvertising();
+}
+
+// Drops one bond at runtime: its link, the stack's keys, the allowlist and whitelist entry,
+// its connection profiles and its registry record. Advertising carries on for everyone else.
+static void forgetDevice(const uint8_t *address, const AuditEvent reason) {
+    esp_bd_addr_t target;
+    memcpy(target, address, ESP_BD_ADDR_LEN); // address may point into the registry
+    uint16_t connId = 0;
+    if (connections.findByAddress(target, connId)) ble::disconnect(connId);
+    ble::removeBond(target);
+    bondAllowlist.remove(target);
+    connParams.forgetProfiles(target);
+    deviceRegistry.remove(target);
+    if (!deviceRegistry.save()) LOG_WARN(LOG_REGISTRY_SAVE_FAILED); // Not worth batching, and must not be lost
+    registryChanged();
+    audit(reason, target);
+    if (reason == AuditEvent::Evicted) {
+        LOG_WARN_ADDR(LOG_DEVICE_EVICTED, target);
+    } else {
+        LOG_WARN_ADDR(LOG_DEVICE_REVOKED, target);
+    }
+    advertiseIfRoom(); // Restarting rebuilds the controller whitelist without the address
+}
+
+// The stack refuses new bonds once its table is full, and the phone only sees pairing fail.
+// Once a pairing is under way, the least recently seen device that is not connected makes
+// room; a window that closes unused costs nobody their bond.
+static void makeRoomForPairing() {
+    if (bondAllowlist.size() < MAX_BONDED_DEVICES) return;
+    const DeviceRecord *oldest = deviceRegistry.leastRecentlySeen(connections);
+    if (oldest) forgetDevice(oldest->address, AuditEvent::Evicted);
+}
+
+// TIMER_PAIRING_TIMEOUT handler: closes the pairing window if no connection or pairing occurred
+void pairingTimeout() {
+    if (!pairingModeActive) return;
+    if (connections.count() > 0) {
+        // A device is connected and may still be pairing, check again later
+        scheduler.schedule(TIMER_PAIRING_TIMEOUT, PAIRING_TIMEOUT_RECHECK_MILLIS);
+        return;
+    }
+    LOG_INFO(LOG_PAIRING_TIMED_OUT, PAIRING_WINDOW_TIMEOUT_MILLIS / 1000);
+    pairingModeActive = false; // Deactivate pairing mode flag
+    allowNewPairing = false;   // Disable new pairing
+    advertiseIfRoom();         // Back to whitelist-only advertising for the bonded devices
+    displayString("PAIr StP", 0);
+}
+
+// TIMER_READVERTISE handler, armed by onDisconnect
+void readvertise() {
+    if (connections.isFull()) return; // The next disconnect rearms it
+    startAdvertising();
+    LOG_INFO(LOG_READVERTISED);
+}
+
+// Points TIMER_CONN_IDLE at the next link due for the idle profile
+static void armConnIdle() {
+    const unsigned long wait = connParams.millisUntilIdle(millis());
+    if (wait == ULONG_MAX) {
+        scheduler.cancel(TIMER_CONN_IDLE);
+    } else {
+        scheduler.schedule(TIMER_CONN_IDLE, wait);
+    }
+}
+
+// TIMER_CONN_IDLE handler: links that went quiet drop to the low power profile
+void connIdle() {
+    connParams.idleDue(millis());
+    armConnIdle();
+}
+
+// Copies the gauges owned by other modules into the telemetry counters before an export
+void refreshTelemetryGauges() {
+    telemetry.set(COUNTER_DISPLAY_FLUSH_MAX_US, display.timing().maxMicros);
+    telemetry.set(COUNTER_BLE_EVENTS, bleEvents.pushedCount());
+    telemetry.set(COUNTER_BLE_EVENTS_DROPPED, bleEvents.droppedCount());
+    telemetry.set(COUNTER_BLE_QUEUE_HIGH_WATER, bleEvents.highWaterMark());
+    telemetry.set(COUNTER_LOG_WRITTEN, logger.writtenCount());
+    telemetry.set(COUNTER_LOG_DROPPED, logger.droppedCount());
+    telemetry.set(COUNTER_AUDIT_RECORDS, auditLog.storedCount());
+    telemetry.set(COUNTER_AUDIT_FLASH_WRITES, auditLog.flashWrites());
+    telemetry.set(COUNTER_AUDIT_SECTOR_ERASES, auditLog.sectorErases());
+    telemetry.set(COUNTER_REGISTRY_WRITES, deviceRegistry.writeCount());
+    static_assert(COUNTER_BOOT_DEFERRED_DONE_US - COUNTER_BOOT_SETUP_US + 1 == BOOT_PHASE_COUNT, "One counter per boot phase");
+    for (uint8_t phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+        telemetry.set(static_cast<Counter>(COUNTER_BOOT_SETUP_US + phase), bootTimeline.at(static_cast<BootPhase>(phase)));
+    }
+
+    // Walks the heap under its lock, fine for an export but not for a hot path
+    multi_heap_info_t heap{};
+    heap_caps_get_info(&heap, TRACKED_HEAP_CAPS);
+    telemetry.set(COUNTER_HEAP_FREE, heap.total_free_bytes);
+    telemetry.set(COUNTER_HEAP_LARGEST_BLOCK, heap.largest_free_block);
+    telemetry.set(COUNTER_HEAP_MIN_FREE, heap.minimum_free_bytes);
+    telemetry.set(COUNTER_HEAP_ALLOCATED_BLOCKS, heap.allocated_blocks);
+    telemetry.set(COUNTER_HEAP_FREE_BLOCKS, heap.free_blocks);
+    telemetry.set(COUNTER_HEAP_BOOT_BLOCKS, heapBlocksAtBoot);
+}
+
+// Runs on the first loop() pass, once setup() has advertising up
+void deferredInit() {
+    display.begin(6); // Anything drawn before this was kept in the framebuffer
+    if (connections.count() == 0) displayIdleStart();
+
+    LOG_INFO(LOG_BOOT_BANNER);
+    if (!bondAllowlist.isEmpty()) {
+        LOG_INFO(LOG_BOOT_BONDED);
+    } else {
+        LOG_INFO(LOG_BOOT_NO_BONDS);
+    }
+    listBondedDevices();
+
+    // Scans the first record of every sector, a few ms that advertising need not wait for
+    if (auditLog.begin()) {
+        LOG_INFO(LOG_AUDIT_READY, auditLog.storedCount(), auditLog.nextSequence());
+    } else {
+        LOG_WARN(LOG_AUDIT_MISSING);
+    }
+    // Walks the whole app image, so it waits until advertising is up
+    telemetry.set(COUNTER_FLASH_IMAGE_BYTES, ESP.getSketchSize());
+    LOG_INFO(LOG_BLE_FOOTPRINT, telemetry.get(COUNTER_BLE_INIT_US), telemetry.get(COUNTER_BLE_HEAP_BYTES),
+             telemetry.get(COUNTER_FLASH_IMAGE_BYTES));
+
+    // The boot record queued by setup() gets its sequence number on the first flush
+    if (auditLog.hasUnsaved() && !scheduler.isScheduled(TIMER_AUDIT_FLUSH)) {
+        scheduler.schedule(TIMER_AUDIT_FLUSH, AUDIT_FLUSH_MILLIS);
+    }
+
+    bootTimeline.mark(BOOT_DEFERRED_DONE);
+    // Boot messages ahead of the timeline, which is written while the log task is kept off Serial
+    logger.flush(Serial, [](Print &out) { bootTimeline.dump(out); });
+
+    // Everything after this point runs from static buffers, so the live block count should hold
+    multi_heap_info_t heap{};
+    heap_caps_get_info(&heap, TRACKED_HEAP_CAPS);
+    heapBlocksAtBoot = heap.allocated_blocks;
+}
+
+// --- Event handling on the loop task ---
+
+// Notifies one connection only, if it enabled notifications in its CCCD. Replies, relay
+// progress and the door state all go through here.
+static void notifyConnection(const uint16_t connId, const uint8_t *data, const size_t length) {
+    ble::setValue(BleCharacteristic::Control, data, length); // Keep reads consistent
+    if (connections.isSubscribed(connId, BleCharacteristic::Control)) {
+        ble::notify(BleCharacteristic::Control, connId, data, length);
+    }
+}
+
+static void notifyReply(const uint16_t connId, const Reply &reply) {
+    notifyConnection(connId, reinterpret_cast<const uint8_t *>(&reply), sizeof(Reply));
+}
+
+static void notifyText(const uint16_t connId, const char *text) {
+    notifyConnection(connId, reinterpret_cast<const uint8_t *>(text), strlen(text));
+}
+
+static void addTriggerWaiter(const uint16_t connId, const uint8_t seq, const bool binary) {
+    for (uint8_t i = 0; i < triggerWaiterCount; i++) {
+        if (triggerWaiters[i].connId == connId) return; // Progress keeps the seq of that peer's first request
+    }
+    if (triggerWaiterCount < MAX_CONNECTIONS) triggerWaiters[triggerWaiterCount++] = {connId, seq, binary};
+}
+
+static void removeTriggerWaiter(const uint16_t connId) {
+    for (uint8_t i = 0; i < triggerWaiterCount; i++) {
+        if (triggerWaiters[i].connId != connId) continue;
+        triggerWaiters[i] = triggerWaiters[--triggerWaiterCount];
+        return;
+    }
+}
+
+// Reports relay progress to every requester of the running pulse, each in the protocol it used
+void notifyActuationProgress(const ReplyStatus status, const char *text) {
+    for (uint8_t i = 0; i < triggerWaiterCount; i++) {
+        const TriggerWaiter &waiter = triggerWaiters[i];
+        if (waiter.binary) {
+            notifyReply(waiter.connId, makeReply(waiter.seq, OP_TRIGGER, status));
+        } else {
+            notifyText(waiter.connId, text);
+        }
+    }
+    if (status == STATUS_RELEASED) triggerWaiterCount = 0;
+}
+
+static Reply doorStatusReply(const uint8_t seq) {
+    Reply reply = makeReply(seq, OP_DOOR_STATUS, STATUS_OK);
+    const uint16_t status = doorStatus.load(std::memory_order_relaxed);
+    reply.data[0] = status & 0xFF;
+    reply.data[1] = status >> 8;
+    return reply;
+}
+
+// Caches the door state for reads and records it
+static DoorState cacheDoorState() {
+    const DoorState state = doorSensor.state();
+    doorStatus.store(static_cast<uint8_t>(state) | doorSensor.transitions() << 8, std::memory_order_relaxed);
+    LOG_INFO(static_cast<LogEvent>(LOG_DOOR_UNKNOWN + static_cast<uint8_t>(state)));
+    if (state == DoorState::Closed) audit(AuditEvent::DoorClosed, nullptr);
+    if (state == DoorState::Open) audit(AuditEvent::DoorOpened, nullptr);
+    if (state == DoorState::Fault) audit(AuditEvent::DoorFault, nullptr);
+    return state;
+}
+
+void initDoorState() {
+    notifiedDoorState = cacheDoorState(); // Nobody to tell yet, clients read it after connecting
+}
+
+// A door transition: cached at once for reads, pushed once the burst has settled
+void handleDoorChange() {
+    cacheDoorState();
+    if (scheduler.isScheduled(TIMER_DOOR_NOTIFY)) {
+        telemetry.count(COUNTER_DOOR_COALESCED);
+    } else {
+        scheduler.schedule(TIMER_DOOR_NOTIFY, DOOR_NOTIFY_COALESCE_MILLIS);
+    }
+}
+
+// TIMER_DOOR_NOTIFY handler: pushes the settled door state to every authenticated, subscribed link
+void doorNotify() {
+    const DoorState state = doorSensor.state();
+    if (state == notifiedDoorState) { // The burst ended where it started
+        telemetry.count(COUNTER_DOOR_COALESCED);
+        return;
+    }
+    notifiedDoorState = state;
+    const Reply reply = doorStatusReply(0);
+    uint16_t connIds[MAX_CONNECTIONS];
+    const uint8_t links = connections.authenticated(connIds);
+    for (uint8_t i = 0; i < links; i++) notifyReply(connIds[i], reply); // Unsubscribed links are skipped
+    telemetry.count(COUNTER_DOOR_NOTIFICATIONS);
+}
+
+// Starts a relay pulse, or folds the request into the one already running.
+// @return STATUS_ACCEPTED, STATUS_COALESCED or STATUS_BUSY
+static ReplyStatus requestTrigger(const BleEvent &event, const bool binary) {
+    Connection connection{};
+    const uint8_t *address = peerAddress(event.connId, connection);
+    if (address) {
+        deviceRegistry.countTrigger(address);
+        registryChanged();
+    }
+    if (actuator.trigger()) {
+        audit(AuditEvent::Trigger, address);
+        triggerWaiterCount = 0;
+        triggerWrittenAt = event.timestamp;
+        addTriggerWaiter(event.connId, event.command.seq, binary);
+        return STATUS_ACCEPTED;
+    }
+    if (!actuator.isBusy()) return STATUS_BUSY; // Timer could not be started
+    // Another trigger inside the pulse window: one relay action serves both
+    addTriggerWaiter(event.connId, event.command.seq, binary);
+    audit(AuditEvent::Trigger, address);
+    telemetry.count(COUNTER_COALESCED_TRIGGERS);
+    return STATUS_COALESCED;
+}
+
+static Reply executeCommand(const BleEvent &event) {
+    const CommandRecord &command = event.command;
+    switch (command.opcode) {
+        case OP_TRIGGER: {
+            // The pulse itself runs on the actuator timers; loop() reports energized/released
+            const ReplyStatus status = requestTrigger(event, true);
+            if (status == STATUS_ACCEPTED) LOG_INFO(LOG_TRIGGER_ACCEPTED, command.seq);
+            return makeReply(command.seq, command.opcode, status);
+        }
+
+        case OP_STATUS: {
+            Reply reply = makeReply(command.seq, command.opcode, STATUS_OK);
+            reply.data[0] = (actuator.isBusy() ? STATE_RELAY_BUSY : 0) |
+                            (pairingModeActive ? STATE_PAIRING_ACTIVE : 0) |
+                            (connections.count() > 0 ? STATE_CONNECTED : 0);
+            reply.data[1] = bondAllowlist.size();
+            const uint32_t pulseMillis = actuator.getPulseMillis();
+            reply.data[2] = pulseMillis & 0xFF;
+            reply.data[3] = (pulseMillis >> 8) & 0xFF;
+            return reply;
+        }
+
+        case OP_CONN_PROFILE: {
+            Connection connection{};
+            const auto kind = static_cast<ConnProfileKind>(command.payload[0]);
+            if (command.length == 0 || kind >= ConnProfileKind::Count || !connections.find(event.connId, connection)) {
+                return makeReply(command.seq, command.opcode, STATUS_MALFORMED);
+            }
+            if (command.length == 1) {
+                connParams.resetProfile(connection.address, kind);
+            } else if (command.length != 8) {
+                return makeReply(command.seq, command.opcode, STATUS_MALFORMED);
+            } else {
+                const uint8_t *p = command.payload;
+                const ConnProfile profile = {static_cast<uint16_t>(p[1] | p[2] << 8), static_cast<uint16_t>(p[3] | p[4] << 8),
+                                             p[5], static_cast<uint16_t>(p[6] | p[7] << 8)};
+                if (!connParams.setProfile(connection.address, kind, profile)) {
+                    return makeReply(command.seq, command.opcode, STATUS_INVALID_PARAM);
+                }
+            }
+            Reply reply = makeReply(command.seq, command.opcode, STATUS_OK);
+            BleConnParams negotiated{};
+            connParams.negotiated(event.connId, negotiated);
+            reply.data[0] = negotiated.interval & 0xFF;
+            reply.data[1] = negotiated.interval >> 8;
+            reply.data[2] = negotiated.latency > UINT8_MAX ? UINT8_MAX : negotiated.latency;
+            return reply;
+        }
+
+        case OP_AUDIT_READ: {
+            if (command.length != 0 && command.length != 4) return makeReply(command.seq, command.opcode, STATUS_MALFORMED);
+            if (auditStream.active && auditStream.connId != event.connId) {
+                return makeReply(command.seq, command.opcode, STATUS_BUSY); // Another peer is downloading
+            }
+            auditLog.flush(); // Everything up to this command is part of the download
+            const uint8_t *p = command.payload;
+            const uint32_t from = command.length == 4 ? p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24 : 0;
+            const uint32_t start = from > auditLog.oldestSequence() ? from : auditLog.oldestSequence();
+            const uint32_t end = auditLog.nextSequence();
+            const uint32_t count = start < end ? end - start : 0;
+            auditStream = {count > 0, event.connId, start, end};
+            if (count > 0) scheduler.schedule(TIMER_AUDIT_STREAM, 0); // Starts after this reply
+            Reply reply = makeReply(command.seq, command.opcode, STATUS_OK);
+            reply.data[0] = count & 0xFF;
+            reply.data[1] = (count >> 8) & 0xFF;
+            reply.data[2] = (count >> 16) & 0xFF;
+            reply.data[3] = count >> 24;
+            return reply;
+        }
+
+        case OP_DOOR_STATUS:
+            return doorStatusReply(command.seq);
+
+        case OP_DEVICE_NAME: {
+            Connection connection{};
+            if (!connections.find(event.connId, connection) ||
+                !deviceRegistry.setName(connection.address, command.payload, command.length)) {
+                return makeReply(command.seq, command.opcode, STATUS_MALFORMED);
+            }
+            registryChanged();
+            return makeReply(command.seq, command.opcode, STATUS_OK);
+        }
+
+        case OP_DEVICE_REVOKE: {
+            if (command.length != ESP_BD_ADDR_LEN) return makeReply(command.seq, command.opcode, STATUS_MALFORMED);
+            if (!bondAllowlist.contains(command.payload)) {
+                return makeReply(command.seq, command.opcode, STATUS_INVALID_PARAM);
+            }
+            forgetDevice(command.payload, AuditEvent::Revoked);
+            Reply reply = makeReply(command.seq, command.opcode, STATUS_OK);
+            reply.data[0] = bondAllowlist.size();
+            return reply;
+        }
+
+        default:
+            LOG_WARN(LOG_UNKNOWN_OPCODE, command.opcode, command.seq);
+            return makeReply(command.seq, command.opcode, STATUS_UNKNOWN_OPCODE);
+    }
+}
+
+static void handleTextCommand(const BleEvent &event) {
+    // --- Your Garage Door Control Logic ---
+    if (event.command.opcode != OP_TRIGGER) {
+        LOG_WARN(LOG_UNKNOWN_TEXT);
+        notifyText(event.connId, "Unknown command received");
+        return;
+    }
+
+    switch (requestTrigger(event, false)) {
+        case STATUS_ACCEPTED:
+            LOG_INFO(LOG_TEXT_TRIGGER_ACCEPTED);
+            notifyText(event.connId, "Command accepted");
+            break;
+        case STATUS_COALESCED:
+            LOG_INFO(LOG_TRIGGER_COALESCED);
+            notifyText(event.connId, "Command accepted");
+            break;
+        default:
+            LOG_WARN(LOG_RELAY_BUSY);
+            notifyText(event.connId, "Relay busy");
+            break;
+    }
+}
+
+// Tells the sender a command was refused before it ran
+static void rejectCommand(const BleEvent &event, const ReplyStatus status, const char *text) {
+    if (event.flags & BLE_EVENT_TEXT) {
+        notifyText(event.connId, text);
+    } else if (!(event.command.flags & FLAG_NO_REPLY) || status == STATUS_MALFORMED) {
+        notifyReply(event.connId, makeReply(event.command.seq, event.command.opcode, status));
+    }
+}
+
+static void handleCommand(const BleEvent &event) {
+    // Additional safety check - although the ESP32 BLE stack should already enforce security
+    if (bondAllowlist.isEmpty()) {
+        LOG_WARN(LOG_WRITE_NO_BONDS);
+        rejectCommand(event, STATUS_NOT_AUTHORIZED, "Security error: No bonded devices");
+        return;
+    }
+    // Only links that finished authentication may operate the door
+    if (!connections.isAuthenticated(event.connId)) {
+        LOG_WARN(LOG_WRITE_UNAUTHENTICATED, event.connId);
+        rejectCommand(event, STATUS_NOT_AUTHORIZED, "Security error: Not authenticated");
+        return;
+    }
+    // Shorten the interval while the peer is busy, the rest of its commands usually follow
+    connParams.onActivity(event.connId, millis());
+    armConnIdle();
+
+    if (event.flags & BLE_EVENT_TEXT) {
+        handleTextCommand(event);
+        return;
+    }
+    if (event.flags & BLE_EVENT_MALFORMED) {
+        LOG_WARN(LOG_MALFORMED_FRAME);
+        rejectCommand(event, STATUS_MALFORMED, nullptr);
+        return;
+    }
+
+    const Reply reply = executeCommand(event);
+    if (!(event.command.flags & FLAG_NO_REPLY)) notifyReply(event.connId, reply);
+}
+
+void processCommands() {
+    BleEvent event;
+    while (commandQueue.pop(event)) handleCommand(event);
+}
+
+// Connection state machine, fed one event at a time from the BLE event queue
+void handleBleEvent(const BleEvent &event) {
+    bleEventCounts[static_cast<uint8_t>(event.type)]++;
+
+    switch (event.type) {
+        case BleEventType::Connected:
+            LOG_INFO_ADDR(LOG_CONNECTED, event.address, event.value);
+            if (event.value == ESP_OK) audit(AuditEvent::Connect, event.address);
+            displayIdleStop();
+            if (event.value == ESP_OK) {
+                displayString("COn 6ood", 0);
+            } else {
+                displayString("COn FAil", 0);
+            }
+            // The stack stops advertising on every connect; keep it up so other phones get straight in
+            advertiseIfRoom();
+            if (!scheduler.isScheduled(TIMER_STATS_REFRESH)) scheduler.schedule(TIMER_STATS_REFRESH, 0);
+            break;
+
+        case BleEventType::ConnectRejected:
+            LOG_WARN_ADDR(LOG_CONNECT_REJECTED, event.address);
+            audit(AuditEvent::ConnectRejected, event.address);
+            displayString("UNAUTH", 0);
+            break;
+
+        case BleEventType::Disconnected:
+            LOG_INFO(LOG_DISCONNECTED, event.connId);
+            displayString("COn Dis", 0);
+            commandQueue.drop(event.connId);
+            removeTriggerWaiter(event.connId);
+            if (auditStream.connId == event.connId) auditStream.active = false;
+            connParams.onDisconnected(event.connId);
+            armConnIdle();
+            if (connections.count() == 0) displayIdleStart(); // Shows once the status text runs out
+            if (!bondAllowlist.isEmpty()) {
+                displayString("Adv st", 0);
+                scheduler.schedule(TIMER_READVERTISE, READVERTISE_DELAY_MILLIS); // Give the BLE stack time to reset
+            }
+            break;
+
+        case BleEventType::PairingRejected: {
+            LOG_WARN(LOG_PAIRING_REJECTED);
+            Connection connection{};
+            audit(AuditEvent::PairingRejected, peerAddress(event.connId, connection));
+            break;
+        }
+
+        case BleEventType::Passkey:
+            currentDisplayedPasskey = event.value; // Store for potential display loop
+            LOG_INFO(LOG_PASSKEY, event.value);
+            displayPasskey(event.value); // Stays on top of status text until authentication ends
+            makeRoomForPairing(); // Before the stack stores the new bond at the end of pairing
+            break;
+
+        case BleEventType::SecurityRequest:
+            if (event.flags & BLE_EVENT_SUCCESS) {
+                LOG_INFO(LOG_SECURITY_ALLOWED);
+            } else {
+                LOG_WARN(LOG_SECURITY_REJECTED);
+                Connection connection{};
+                audit(AuditEvent::PairingRejected, peerAddress(event.connId, connection));
+                displayString("SEC rEj", 0, "", REJECT_DISPLAY_MILLIS);
+            }
+            break;
+
+        case BleEventType::AuthComplete:
+            currentDisplayedPasskey = 0; // Clear the passkey once authentication is done
+            displayPasskeyClear(); // Clear the passkey after authentication
+            if (event.flags & BLE_EVENT_SUCCESS) {
+                LOG_INFO_ADDR(LOG_AUTH_OK, event.address);
+                if (event.flags & BLE_EVENT_RELOAD_BONDS) bondAllowlist.load();
+                // A bonded phone re-encrypting while the window is open did not pair
+                if (event.flags & BLE_EVENT_NEW_BOND) audit(AuditEvent::Paired, event.address);
+                deviceRegistry.touch(event.address);
+                registryChanged();
+                displayString("SEC PASS", 0);
+                Connection connection{};
+                if (connections.find(event.connId, connection) && connection.state == LinkState::Authenticated) {
+                    connParams.onAuthenticated(event.connId, connection.address, millis()); // Fast until it goes quiet
+                    armConnIdle();
+                }
+            } else {
+                displayString("SEC FAIL", 0);
+                LOG_WARN(LOG_AUTH_FAILED, event.value);
+            }
+
+            if (pairingModeActive) {
+                scheduler.cancel(TIMER_PAIRING_TIMEOUT);
+                pairingModeActive = false;
+                allowNewPairing = false;  // Reset the pairing flag
+                advertiseIfRoom();        // Whitelist-only again, now including the new bond
+                LOG_INFO(LOG_PAIRING_CLOSED);
+            }
+            break;
+
+        case BleEventType::Command:
+            // Queued per connection and run by processCommands() once the event queue is drained
+            if (!commandQueue.push(event)) {
+                telemetry.count(COUNTER_COMMANDS_DROPPED);
+                rejectCommand(event, STATUS_BUSY, "Relay busy");
+            }
+            break;
+
+        case BleEventType::ConnParamsUpdated:
+            if (event.flags & BLE_EVENT_SUCCESS) {
+                const BleConnParams &params = event.connParams;
+                connParams.onNegotiated(event.connId, params);
+                telemetry.count(COUNTER_CONN_PARAM_UPDATES);
+                telemetry.record(HIST_CONN_EVENT_PERIOD, params.interval * 1250UL * (1UL + params.latency));
+                LOG_DEBUG(LOG_CONN_PARAMS, event.connId, params.interval * 1250UL, params.latency, params.timeout * 10UL);
+            } else {
+                telemetry.count(COUNTER_CONN_PARAM_FAILURES);
+                LOG_WARN(LOG_CONN_PARAMS_FAILED, event.connId, event.value);
+            }
+            break;
+
+        case BleEventType::Count:
+            break;
+    }
+}
+
+
+// Reacts to one button event from the ButtonMonitor state machine
+void handleButtonEvent(const ButtonEvent &event) {
+    // The pairing hold is ignored while pairing mode is already active
+    if (pairingModeActive && !button.isResetHold()) return;
+
+    switch (event.type) {
+        case ButtonEventType::HoldCountdown: {
+            const char *prefix = button.isResetHold() ? "rst" : "PAIr";
+            displayString(event.secondsRemaining, strlen(prefix), prefix);
+            LOG_DEBUG(LOG_HOLD_COUNTDOWN, event.secondsRemaining);
+            break;
+        }
+
+        case ButtonEventType::ShortPress:
+        case ButtonEventType::HoldCancelled:
+            displayClear();
+            break;
+
+        case ButtonEventType::FactoryResetHold:
+            displayString("FCT rST", 0);
+            clearBondedDevices();
+            break;
+
+        case ButtonEventType::PairingHold:
+            pairingModeActive = true;
+            allowNewPairing = true; // Enable new pairing attempts during this window
+            startAdvertising();     // Open to every device until the window closes
+            scheduler.schedule(TIMER_PAIRING_TIMEOUT, PAIRING_WINDOW_TIMEOUT_MILLIS);
+            LOG_INFO(LOG_PAIRING_ACTIVE, PAIRING_WINDOW_TIMEOUT_MILLIS / 1000);
+            audit(AuditEvent::PairingOpened, nullptr);
+            displayString("PAIr ACt", 0);
+            break;
+
+        case ButtonEventType::None:
+            break;
+    }
+}
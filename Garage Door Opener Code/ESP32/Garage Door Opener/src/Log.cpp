@@ -0,0 +1,170 @@
+#include "Log.h"
+
+namespace {
+
+// Printed with the record's arguments; an address record passes the address string first
+constexpr const char *LOG_FORMATS[LOG_EVENT_COUNT] = {
+    "--- ESP32 BLE Secure Server with Passkey Entry & Bonding ---",
+    "Advertising to bonded devices. Hold the pairing button 5 s to pair another.",
+    "No bonded devices. Hold the pairing button 5 s to pair one.",
+    "%u bonded device(s)",
+    "  Bonded: %s",
+    "Clearing all bonded devices from NVS...",
+    "All bonded devices removed. Restarting...",
+    "PAIRING MODE ACTIVATED, open advertising for %u s",
+    "Pairing mode timed out, no connection within %u s",
+    "Pairing mode closed after authentication attempt",
+    "UNAUTHORIZED PAIRING ATTEMPT - passkey not shown",
+    "****** PAIRING PASSKEY TO ENTER ON CLIENT: %06u ******",
+    "Passkey request (not expected with ESP_IO_CAP_OUT)",
+    "Confirm PIN (numeric comparison): %06u",
+    "Security request allowed",
+    "SECURITY REQUEST REJECTED - not in pairing mode",
+    "Authentication SUCCESS, bonded %s",
+    "Authentication FAILED, reason %u",
+    "Connected %s (status %u), awaiting authentication",
+    "UNAUTHORIZED CONNECTION from %s - disconnected",
+    "Connection %u closed, restarting advertising",
+    "Advertising restarted for bonded devices",
+    "Whitelist holds %u of %u bonds, not filtering",
+    "Conn %u params: %u us, latency %u, timeout %u ms",
+    "Conn %u parameter update failed (status %u)",
+    "BLE event queue full, %u event(s) dropped",
+    "--- Garage door trigger accepted (seq %u) ---",
+    "--- Garage door trigger accepted ---",
+    "Trigger joined the running relay pulse",
+    "Relay busy, trigger ignored",
+    "--- Relay energized ---",
+    "--- Relay released ---",
+    "Unknown opcode 0x%02x (seq %u)",
+    "Unknown text command",
+    "Write with no bonded devices, ignored",
+    "Write from unauthenticated connection %u, ignored",
+    "Malformed command frame",
+    "Hold for %u more seconds...",
+    "Display: %u digit(s) sent in %u us",
+    "Audit log: %u records, next %u",
+    "No audit partition, door events are not kept",
+    "Device %s revoked",
+    "Bond table full, least recently seen device %s removed",
+    "Device registry could not be saved, retrying",
+    "Door position unknown",
+    "Door closed",
+    "Door open",
+    "Door moving",
+    "DOOR FAULT - no limit reached within the travel time",
+#ifdef BLE_BACKEND_NIMBLE
+    "NimBLE up in %u us, %u bytes of heap, %u byte image",
+#else
+    "Bluedroid up in %u us, %u bytes of heap, %u byte image",
+#endif
+};
+
+const char LEVEL_TAGS[] = {'-', 'E', 'W', 'I', 'D'};
+
+// Most characters a format can print: an address takes 17, a number at most 10
+constexpr size_t expandedLength(const char *format) {
+    size_t length = 0;
+    while (*format) {
+        if (*format++ != '%') {
+            length++;
+            continue;
+        }
+        while (*format >= '0' && *format <= '9') format++; // Widths here are all below 10
+        length += *format++ == 's' ? 17 : 10;
+    }
+    return length;
+}
+
+constexpr size_t longestExpansion() {
+    size_t longest = 0;
+    for (const char *format : LOG_FORMATS) {
+        if (expandedLength(format) > longest) longest = expandedLength(format);
+    }
+    return longest;
+}
+
+// Messages are formatted into a buffer on the log task's stack: Print::printf allocates
+// for 64 characters or more, which several messages reach with large arguments
+constexpr size_t LOG_MESSAGE_CHARS = 96;
+static_assert(longestExpansion() < LOG_MESSAGE_CHARS, "A log message could be cut short");
+
+} // namespace
+
+void Logger::begin(Print &out) {
+    output = &out;
+    xTaskCreatePinnedToCore(task, "log", LOG_TASK_STACK_BYTES, this, LOG_TASK_PRIORITY, nullptr, tskNO_AFFINITY);
+}
+
+void Logger::task(void *arg) {
+    auto *self = static_cast<Logger *>(arg);
+    for (;;) {
+        self->drain(*self->output);
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_MILLIS));
+    }
+}
+
+void Logger::write(const uint8_t level, const LogEvent event, const uint32_t a, const uint32_t b, const uint32_t c,
+                   const uint32_t d) {
+    ring.push({static_cast<uint32_t>(millis()), level, event, false, {a, b, c, d}});
+}
+
+void Logger::writeAddress(const uint8_t level, const LogEvent event, const uint8_t *address, const uint32_t a,
+                          const uint32_t b) {
+    LogRecord record{static_cast<uint32_t>(millis()), level, event, true, {0, 0, a, b}};
+    memcpy(record.args, address, 6);
+    ring.push(record);
+}
+
+size_t Logger::drain(Print &out) {
+    if (draining.exchange(true, std::memory_order_acquire)) return 0;
+    const size_t printed = drainLocked(out);
+    draining.store(false, std::memory_order_release);
+    return printed;
+}
+
+void Logger::flush(Print &out, void (*direct)(Print &out)) {
+    // Wait out a drain in progress on the log task, its records come first
+    while (draining.exchange(true, std::memory_order_acquire)) vTaskDelay(1);
+    drainLocked(out);
+    if (direct) direct(out); // Records logged meanwhile wait for the next drain
+    draining.store(false, std::memory_order_release);
+}
+
+size_t Logger::drainLocked(Print &out) {
+    size_t printed = 0;
+    LogRecord record;
+    while (ring.pop(record)) {
+        out.printf("%lu.%03lu %c ", static_cast<unsigned long>(record.millis / 1000),
+                   static_cast<unsigned long>(record.millis % 1000),
+                   record.level < sizeof(LEVEL_TAGS) ? LEVEL_TAGS[record.level] : '?');
+        const char *format = LOG_FORMATS[record.event];
+        char message[LOG_MESSAGE_CHARS];
+        int length;
+        if (record.address) {
+            const auto *address = reinterpret_cast<const uint8_t *>(record.args);
+            char text[18];
+            snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+                     address[0], address[1], address[2], address[3], address[4], address[5]);
+            length = snprintf(message, sizeof(message), format, text, static_cast<unsigned>(record.args[2]),
+                              static_cast<unsigned>(record.args[3]));
+        } else {
+            length = snprintf(message, sizeof(message), format, static_cast<unsigned>(record.args[0]),
+                              static_cast<unsigned>(record.args[1]), static_cast<unsigned>(record.args[2]),
+                              static_cast<unsigned>(record.args[3]));
+        }
+        if (length > 0) {
+            const size_t fits = static_cast<size_t>(length) < sizeof(message) ? length : sizeof(message) - 1;
+            out.write(reinterpret_cast<const uint8_t *>(message), fits);
+        }
+        out.println();
+        printed++;
+    }
+
+    const uint32_t dropped = ring.droppedCount();
+    if (dropped != reportedDrops) {
+        out.printf("Log: %lu message(s) dropped\r\n", static_cast<unsigned long>(dropped - reportedDrops));
+        reportedDrops = dropped;
+    }
+    return printed;
+}
@@ -0,0 +1,178 @@
+#include "Max7219Display.h"
+
+namespace {
+
+// MAX7219 register addresses
+constexpr uint8_t REG_DIGIT0      = 0x01;
+constexpr uint8_t REG_DECODE_MODE = 0x09;
+constexpr uint8_t REG_INTENSITY   = 0x0A;
+constexpr uint8_t REG_SCAN_LIMIT  = 0x0B;
+constexpr uint8_t REG_SHUTDOWN    = 0x0C;
+constexpr uint8_t REG_DISPLAY_TEST = 0x0F;
+
+constexpr uint32_t SPI_CLOCK_HZ = 5000000; // MAX7219 tops out at 10 MHz
+
+// Segment bits in no-decode mode
+constexpr uint8_t SEG_DP = 0x80;
+constexpr uint8_t SEG_A  = 0x40;
+constexpr uint8_t SEG_B  = 0x20;
+constexpr uint8_t SEG_C  = 0x10;
+constexpr uint8_t SEG_D  = 0x08;
+constexpr uint8_t SEG_E  = 0x04;
+constexpr uint8_t SEG_F  = 0x02;
+constexpr uint8_t SEG_G  = 0x01;
+
+// Closest 7-segment rendering of each character; letters that cannot be drawn are blank
+constexpr uint8_t glyph(const char c) {
+    switch (c) {
+        case '0': case 'O':           return SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F;
+        case '1':                     return SEG_B | SEG_C;
+        case '2': case 'Z': case 'z': return SEG_A | SEG_B | SEG_D | SEG_E | SEG_G;
+        case '3':                     return SEG_A | SEG_B | SEG_C | SEG_D | SEG_G;
+        case '4':                     return SEG_B | SEG_C | SEG_F | SEG_G;
+        case '5': case 'S': case 's': return SEG_A | SEG_C | SEG_D | SEG_F | SEG_G;
+        case '6':                     return SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G;
+        case '7':                     return SEG_A | SEG_B | SEG_C;
+        case '8':                     return SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G;
+        case '9': case 'g':           return SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G;
+        case 'A':                     return SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G;
+        case 'a':                     return SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_G;
+        case 'B': case 'b':           return SEG_C | SEG_D | SEG_E | SEG_F | SEG_G;
+        case 'C':                     return SEG_A | SEG_D | SEG_E | SEG_F;
+        case 'c':                     return SEG_D | SEG_E | SEG_G;
+        case 'D': case 'd':           return SEG_B | SEG_C | SEG_D | SEG_E | SEG_G;
+        case 'E': case 'e':           return SEG_A | SEG_D | SEG_E | SEG_F | SEG_G;
+        case 'F': case 'f':           return SEG_A | SEG_E | SEG_F | SEG_G;
+        case 'G':                     return SEG_A | SEG_C | SEG_D | SEG_E | SEG_F;
+        case 'H': case 'K': case 'X': case 'k': case 'x':
+                                      return SEG_B | SEG_C | SEG_E | SEG_F | SEG_G;
+        case 'h':                     return SEG_C | SEG_E | SEG_F | SEG_G;
+        case 'I':                     return SEG_E | SEG_F;
+        case 'i':                     return SEG_E;
+        case 'J':                     return SEG_B | SEG_C | SEG_D | SEG_E;
+        case 'j':                     return SEG_B | SEG_C | SEG_D;
+        case 'L': case 'l':           return SEG_D | SEG_E | SEG_F;
+        case 'N':                     return SEG_A | SEG_B | SEG_C | SEG_E | SEG_F;
+        case 'n': case 'm': case 'M': return SEG_C | SEG_E | SEG_G;
+        case 'o':                     return SEG_C | SEG_D | SEG_E | SEG_G;
+        case 'P': case 'p':           return SEG_A | SEG_B | SEG_E | SEG_F | SEG_G;
+        case 'Q': case 'q':           return SEG_A | SEG_B | SEG_C | SEG_F | SEG_G;
+        case 'R': case 'r':           return SEG_E | SEG_G;
+        case 'T': case 't':           return SEG_D | SEG_E | SEG_F | SEG_G;
+        case 'U': case 'V':           return SEG_B | SEG_C | SEG_D | SEG_E | SEG_F;
+        case 'u': case 'v': case 'W': case 'w':
+                                      return SEG_C | SEG_D | SEG_E;
+        case 'Y': case 'y':           return SEG_B | SEG_C | SEG_D | SEG_F | SEG_G;
+        case '-':                     return SEG_G;
+        case '_':                     return SEG_D;
+        case '=':                     return SEG_D | SEG_G;
+        case '.': case ',':           return SEG_DP;
+        default:                      return 0;
+    }
+}
+
+struct SegmentTable {
+    uint8_t glyphs[128];
+
+    constexpr SegmentTable() : glyphs() {
+        for (int i = 0; i < 128; i++) glyphs[i] = glyph(static_cast<char>(i));
+    }
+};
+
+constexpr SegmentTable SEGMENT_TABLE{};
+
+} // namespace
+
+Max7219Display::Max7219Display(const int8_t dinPin, const int8_t clkPin, const int8_t csPin)
+    : dinPin(dinPin), clkPin(clkPin), csPin(csPin), spi(VSPI) {}
+
+void Max7219Display::begin(const uint8_t intensity) {
+    pinMode(csPin, OUTPUT);
+    digitalWrite(csPin, HIGH);
+    spi.begin(clkPin, -1, dinPin, -1); // Write-only bus, chip select is driven by hand
+
+    writeRegister(REG_DISPLAY_TEST, 0x00);
+    writeRegister(REG_DECODE_MODE, 0x00);   // Raw segment data for every digit
+    writeRegister(REG_SCAN_LIMIT, MAX7219_DIGITS - 1);
+    setIntensity(intensity);
+    writeRegister(REG_SHUTDOWN, 0x01);
+
+    // Blank the chip and bring the shadow copy in sync with it
+    for (uint8_t digit = 0; digit < MAX7219_DIGITS; digit++) {
+        writeRegister(REG_DIGIT0 + digit, 0x00);
+        shown[digit] = 0;
+    }
+    started = true;
+    if (memcmp(frame, shown, sizeof(frame)) != 0) flush(); // Text drawn while boot deferred begin()
+}
+
+void Max7219Display::setIntensity(const uint8_t intensity) {
+    writeRegister(REG_INTENSITY, intensity & 0x0F);
+}
+
+void Max7219Display::clear() {
+    memset(frame, 0, sizeof(frame));
+}
+
+void Max7219Display::setChar(const uint8_t digit, const char character, const bool decimalPoint) {
+    if (digit >= MAX7219_DIGITS) return;
+    frame[digit] = segmentsFor(character) | (decimalPoint ? SEG_DP : 0);
+}
+
+void Max7219Display::setSegments(const uint8_t digit, const uint8_t segments) {
+    if (digit >= MAX7219_DIGITS) return;
+    frame[digit] = segments;
+}
+
+void Max7219Display::setColumn(const uint8_t column, const bool on) {
+    if (column > 7) return;
+    const uint8_t mask = 0x80 >> column;
+    for (uint8_t &digit : frame) {
+        digit = on ? (digit | mask) : (digit & ~mask);
+    }
+}
+
+uint8_t Max7219Display::flush() {
+    if (!started) return 0;
+
+    uint8_t dirty = 0;
+    for (uint8_t digit = 0; digit < MAX7219_DIGITS; digit++) {
+        if (frame[digit] != shown[digit]) dirty++;
+    }
+    if (dirty == 0) {
+        stats.skippedFlushes++;
+        return 0;
+    }
+
+    const uint32_t start = micros();
+    spi.beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+    for (uint8_t digit = 0; digit < MAX7219_DIGITS; digit++) {
+        if (frame[digit] == shown[digit]) continue;
+        // Each register write is latched by the rising edge of CS
+        digitalWrite(csPin, LOW);
+        spi.transfer16(static_cast<uint16_t>((REG_DIGIT0 + digit) << 8 | frame[digit]));
+        digitalWrite(csPin, HIGH);
+        shown[digit] = frame[digit];
+    }
+    spi.endTransaction();
+    const uint32_t elapsed = micros() - start;
+
+    stats.flushCount++;
+    stats.digitsWritten += dirty;
+    stats.lastMicros = elapsed;
+    if (elapsed > stats.maxMicros) stats.maxMicros = elapsed;
+    return dirty;
+}
+
+uint8_t Max7219Display::segmentsFor(const char character) {
+    const auto index = static_cast<uint8_t>(character);
+    return index < 128 ? SEGMENT_TABLE.glyphs[index] : 0;
+}
+
+void Max7219Display::writeRegister(const uint8_t reg, const uint8_t value) {
+    spi.beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE0));
+    digitalWrite(csPin, LOW);
+    spi.transfer16(static_cast<uint16_t>(reg << 8 | value));
+    digitalWrite(csPin, HIGH);
+    spi.endTransaction();
+}
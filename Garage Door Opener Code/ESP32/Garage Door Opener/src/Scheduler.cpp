@@ -0,0 +1,60 @@
+#include "Scheduler.h"
+
+void Scheduler::begin(TaskHandle_t task) {
+    wakeTask = task;
+}
+
+void Scheduler::setHandler(const uint8_t id, const TimerCallback handler) {
+    if (id >= MAX_TIMERS) return;
+    timers[id].handler = handler;
+}
+
+void Scheduler::schedule(const uint8_t id, const unsigned long delayMillis) {
+    if (id >= MAX_TIMERS) return;
+    portENTER_CRITICAL(&lock);
+    timers[id].deadline = millis() + delayMillis;
+    timers[id].armed = true;
+    portEXIT_CRITICAL(&lock);
+
+    // Let the loop task recompute how long it may sleep
+    if (wakeTask && wakeTask != xTaskGetCurrentTaskHandle()) xTaskNotifyGive(wakeTask);
+}
+
+void Scheduler::cancel(const uint8_t id) {
+    if (id >= MAX_TIMERS) return;
+    portENTER_CRITICAL(&lock);
+    timers[id].armed = false;
+    portEXIT_CRITICAL(&lock);
+}
+
+bool Scheduler::isScheduled(const uint8_t id) const {
+    return id < MAX_TIMERS && timers[id].armed;
+}
+
+void Scheduler::runDue(const unsigned long now) {
+    for (Timer &timer : timers) {
+        bool due = false;
+        portENTER_CRITICAL(&lock);
+        if (timer.armed && static_cast<long>(now - timer.deadline) >= 0) {
+            timer.armed = false;
+            due = true;
+        }
+        portEXIT_CRITICAL(&lock);
+
+        // Outside the lock: handlers may reschedule themselves or other slots
+        if (due && timer.handler) timer.handler();
+    }
+}
+
+unsigned long Scheduler::millisUntilNext(const unsigned long now) const {
+    unsigned long earliest = ULONG_MAX;
+    portENTER_CRITICAL(&lock);
+    for (const Timer &timer : timers) {
+        if (!timer.armed) continue;
+        const long remaining = static_cast<long>(timer.deadline - now);
+        const unsigned long wait = remaining > 0 ? static_cast<unsigned long>(remaining) : 0;
+        if (wait < earliest) earliest = wait;
+    }
+    portEXIT_CRITICAL(&lock);
+    return earliest;
+}
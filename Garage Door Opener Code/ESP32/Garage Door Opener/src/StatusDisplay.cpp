@@ -0,0 +1,151 @@
+#include "StatusDisplay.h"
+
+#include "AppState.h"
+
+namespace {
+constexpr uint8_t SEG_DP = 0x80;
+
+// One frame of the sweep: the same segment line lit on every digit (0 = DP, 1 = A ... 7 = G)
+constexpr AnimationFrame column(const uint8_t line, const uint16_t durationMillis) {
+    const uint8_t mask = 0x80 >> line;
+    return {{mask, mask, mask, mask, mask, mask, mask, mask}, durationMillis};
+}
+
+constexpr AnimationFrame blank(const uint16_t durationMillis) {
+    return {{}, durationMillis};
+}
+
+// Lines 0..7 and back down to 1, 40 ms each
+constexpr AnimationFrame KNIGHT_RIDER_FRAMES[] = {
+    column(0, 40), column(1, 40), column(2, 40), column(3, 40), column(4, 40), column(5, 40), column(6, 40),
+    column(7, 40), column(6, 40), column(5, 40), column(4, 40), column(3, 40), column(2, 40), column(1, 40),
+};
+constexpr Animation KNIGHT_RIDER = {KNIGHT_RIDER_FRAMES, sizeof(KNIGHT_RIDER_FRAMES) / sizeof(AnimationFrame), false};
+
+// The sweep followed by a 200 ms pause, repeated for as long as displayPattern() asks
+constexpr AnimationFrame PATTERN_FRAMES[] = {
+    column(0, 40), column(1, 40), column(2, 40), column(3, 40), column(4, 40), column(5, 40), column(6, 40),
+    column(7, 40), column(6, 40), column(5, 40), column(4, 40), column(3, 40), column(2, 40), column(1, 40),
+    blank(200),
+};
+constexpr Animation PATTERN = {PATTERN_FRAMES, sizeof(PATTERN_FRAMES) / sizeof(AnimationFrame), true};
+
+// Idle heartbeat: the rightmost decimal point blinks every 3 s, one digit sent per frame
+constexpr AnimationFrame IDLE_FRAMES[] = {
+    {{SEG_DP}, 100},
+    blank(2900),
+};
+constexpr Animation IDLE = {IDLE_FRAMES, sizeof(IDLE_FRAMES) / sizeof(AnimationFrame), true};
+} // namespace
+
+// Points TIMER_DISPLAY at the next frame change or expiry
+static void armDisplayTick() {
+    const unsigned long wait = displayEngine.millisUntilTick(millis());
+    if (wait == ULONG_MAX) {
+        scheduler.cancel(TIMER_DISPLAY);
+    } else {
+        scheduler.schedule(TIMER_DISPLAY, wait);
+    }
+}
+
+// Lays str out right-aligned from startSegment with prefix to its left, in raw segments
+static void layoutText(uint8_t (&segments)[MAX7219_DIGITS], const char *str, uint8_t startSegment, const char *prefix) {
+    const uint32_t len = strlen(str);
+    
+    uint8_t segPos;
+    if(startSegment > 7) { len>7 ? segPos = 7: segPos=len; } 
+    else { segPos = 7 - startSegment; }
+    
+    if(prefix[0] != '\0') {
+        // Past the end of prefix the digits stay blank, like String::charAt() returned 0 before
+        const size_t prefixLen = strlen(prefix);
+        byte charAtPos = 0;
+        for (int i = 7; i > segPos; i--) {
+            const char prefixChar = charAtPos < prefixLen ? prefix[charAtPos] : '\0';
+            charAtPos++;
+            segments[i] = Max7219Display::segmentsFor(prefixChar) | (i-1 <= segPos ? SEG_DP : 0);
+        }
+    }
+    
+    for (uint32_t i = 0; i < len; i++) {
+        char charToDisplay = str[i];
+        segments[segPos--] = Max7219Display::segmentsFor(charToDisplay);
+        if (segPos==0 && i+2 < len) {
+            segments[segPos] = Max7219Display::segmentsFor('-');
+            break; 
+        }
+    }
+}
+
+void displayString(const char *str, uint8_t startSegment, const char *prefix, const unsigned long holdMillis) {
+    telemetry.count(COUNTER_DISPLAY_UPDATES);
+    uint8_t segments[MAX7219_DIGITS] = {};
+    layoutText(segments, str, startSegment, prefix);
+
+    // Unchanged digits are not re-sent; nothing is sent while the passkey layer covers the text
+    [[maybe_unused]] const uint8_t digitsSent = displayEngine.show(DisplayLayer::Status, segments, holdMillis, millis());
+    armDisplayTick();
+    LOG_DEBUG(LOG_DISPLAY_SENT, digitsSent, digitsSent ? display.timing().lastMicros : 0);
+}
+
+void displayString(uint32_t numberInt, uint8_t startSegment, const char *prefix) {
+    char digits[11]; // UINT32_MAX has 10 digits
+    char *p = digits + sizeof(digits);
+    *--p = '\0';
+    do {
+        *--p = static_cast<char>('0' + numberInt % 10);
+        numberInt /= 10;
+    } while (numberInt > 0);
+    displayString(p, startSegment, prefix);
+}
+
+void displayClear(){
+    displayEngine.clear(DisplayLayer::Status);
+    armDisplayTick();
+}
+
+void displayPasskey(const uint32_t passkey) {
+    char digits[7]; // Passkeys are 000000..999999, leading zeros included
+    snprintf(digits, sizeof(digits), "%06lu", static_cast<unsigned long>(passkey % 1000000));
+    uint8_t segments[MAX7219_DIGITS] = {};
+    layoutText(segments, digits, 2, "P5");
+    displayEngine.show(DisplayLayer::Passkey, segments, 0, millis());
+    armDisplayTick();
+}
+
+void displayPasskeyClear() {
+    displayEngine.clear(DisplayLayer::Passkey);
+    armDisplayTick();
+}
+
+void knightRiderStart() {
+    displayEngine.play(DisplayLayer::Status, KNIGHT_RIDER, 0, millis());
+    armDisplayTick();
+}
+
+bool knightRiderActive() {
+    return displayEngine.isPlaying(DisplayLayer::Status, KNIGHT_RIDER);
+}
+
+void displayPattern(uint32_t duration){
+    if (duration == 0) return;
+    displayEngine.play(DisplayLayer::Status, PATTERN, duration, millis());
+    armDisplayTick();
+}
+
+void displayIdleStart() {
+    if (displayEngine.isPlaying(DisplayLayer::Idle, IDLE)) return;
+    displayEngine.play(DisplayLayer::Idle, IDLE, 0, millis());
+    armDisplayTick();
+}
+
+void displayIdleStop() {
+    displayEngine.clear(DisplayLayer::Idle);
+    armDisplayTick();
+}
+
+// TIMER_DISPLAY handler
+void displayTick() {
+    displayEngine.tick(millis());
+    armDisplayTick();
+}
@@ -0,0 +1,110 @@
+#include "Telemetry.h"
+
+namespace {
+
+const char *const HISTOGRAM_NAMES[HIST_COUNT] = {
+    "write->relay",
+    "connect->encrypt",
+    "encrypt->auth",
+    "conn event period",
+};
+
+const char *const COUNTER_NAMES[COUNTER_COUNT] = {
+    "rejected connections",
+    "rejected security",
+    "display updates",
+    "coalesced triggers",
+    "commands dropped",
+    "conn param updates",
+    "conn param failures",
+    "display flush max us",
+    "BLE events",
+    "BLE events dropped",
+    "BLE queue high water",
+    "boot setup us",
+    "boot BLE ready us",
+    "boot GATT ready us",
+    "boot advertising us",
+    "boot deferred us",
+    "heap free",
+    "heap largest block",
+    "heap min free",
+    "heap allocated blocks",
+    "heap free blocks",
+    "heap boot blocks",
+    "log written",
+    "log dropped",
+    "audit records",
+    "audit flash writes",
+    "audit sector erases",
+    "registry writes",
+    "door notifications",
+    "door coalesced",
+    "BLE backend",
+    "BLE init us",
+    "BLE heap bytes",
+    "flash image bytes",
+};
+
+uint8_t *putU16(uint8_t *out, const uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+uint8_t *putU32(uint8_t *out, const uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+    return out + 4;
+}
+
+} // namespace
+
+void Log2Histogram::record(const uint32_t micros) {
+    // Bucket = number of significant bits, so 0 us lands in bucket 0 and 1 us in bucket 1
+    uint8_t bucket = micros == 0 ? 0 : 32 - __builtin_clz(micros);
+    if (bucket >= HISTOGRAM_BUCKETS) bucket = HISTOGRAM_BUCKETS - 1;
+    buckets[bucket]++;
+    if (micros < min) min = micros;
+    if (micros > max) max = micros;
+    count++;
+}
+
+size_t Telemetry::serialize(uint8_t *out, const size_t capacity) const {
+    if (capacity < serializedSize()) return 0;
+
+    uint8_t *p = out;
+    *p++ = TELEMETRY_FORMAT_VERSION;
+    *p++ = HIST_COUNT;
+    *p++ = HISTOGRAM_BUCKETS;
+    *p++ = COUNTER_COUNT;
+    for (const auto &counter : counters) p = putU32(p, counter.load(std::memory_order_relaxed));
+    for (const Log2Histogram &histogram : histograms) {
+        p = putU32(p, histogram.count);
+        p = putU32(p, histogram.count ? histogram.min : 0);
+        p = putU32(p, histogram.max);
+        for (const uint32_t bucket : histogram.buckets) p = putU16(p, bucket > UINT16_MAX ? UINT16_MAX : bucket);
+    }
+    return p - out;
+}
+
+void Telemetry::dump(Print &out) const {
+    out.println("\n--- Telemetry ---");
+    for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+        out.printf("  %-22s %lu\n", COUNTER_NAMES[i], static_cast<unsigned long>(get(static_cast<Counter>(i))));
+    }
+    for (uint8_t i = 0; i < HIST_COUNT; i++) {
+        const Log2Histogram &histogram = histograms[i];
+        out.printf("  %-18s n=%lu min=%lu us max=%lu us\n", HISTOGRAM_NAMES[i],
+                   static_cast<unsigned long>(histogram.count),
+                   static_cast<unsigned long>(histogram.count ? histogram.min : 0),
+                   static_cast<unsigned long>(histogram.max));
+        for (uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if (histogram.buckets[bucket] == 0) continue;
+            out.printf("    < %8lu us: %lu\n", 1UL << bucket, static_cast<unsigned long>(histogram.buckets[bucket]));
+        }
+    }
+    out.println("--- End of Telemetry ---");
+}
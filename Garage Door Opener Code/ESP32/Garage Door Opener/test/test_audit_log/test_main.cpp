@@ -0,0 +1,123 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "AuditLog.h"
+
+namespace {
+const uint8_t PHONE[6] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+constexpr uint32_t SECTORS = 0x80000 / SPI_FLASH_SEC_SIZE;
+constexpr uint32_t PER_SECTOR = SPI_FLASH_SEC_SIZE / sizeof(AuditRecord);
+
+void appendMany(AuditLog &log, const uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) log.append(AuditEvent::Trigger, PHONE, 1000);
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_records_reach_flash_in_batches() {
+    AuditLog log;
+    TEST_ASSERT_TRUE(log.begin());
+    appendMany(log, AUDIT_BATCH_RECORDS - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, fake::partitionWrites());
+    TEST_ASSERT_TRUE(log.hasUnsaved());
+
+    log.append(AuditEvent::Connect, PHONE, 61000);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::partitionWrites()); // The whole batch in one write
+    TEST_ASSERT_FALSE(log.hasUnsaved());
+
+    AuditRecord records[AUDIT_BATCH_RECORDS];
+    TEST_ASSERT_EQUAL_UINT32(AUDIT_BATCH_RECORDS, log.read(0, records, AUDIT_BATCH_RECORDS));
+    const AuditRecord &last = records[AUDIT_BATCH_RECORDS - 1];
+    TEST_ASSERT_EQUAL_UINT32(AUDIT_BATCH_RECORDS - 1, last.sequence);
+    TEST_ASSERT_EQUAL_UINT32(61, last.uptimeSeconds);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(AuditEvent::Connect), last.event);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(PHONE, last.address, sizeof(PHONE));
+    TEST_ASSERT_TRUE(AuditLog::isValid(last));
+}
+
+static void test_log_continues_after_a_reboot() {
+    {
+        AuditLog log;
+        log.begin();
+        appendMany(log, 40);
+        log.flush();
+    }
+    AuditLog log;
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_UINT32(0, log.oldestSequence());
+    TEST_ASSERT_EQUAL_UINT32(40, log.nextSequence());
+
+    log.append(AuditEvent::Boot, nullptr, 0);
+    log.flush();
+    AuditRecord record;
+    TEST_ASSERT_EQUAL_UINT32(1, log.read(40, &record, 1));
+    TEST_ASSERT_EQUAL_UINT32(40, record.sequence);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(AuditEvent::Boot), record.event);
+}
+
+static void test_wrapping_erases_every_sector_equally() {
+    AuditLog log;
+    log.begin();
+    const uint32_t total = SECTORS * PER_SECTOR * 3 + 5 * PER_SECTOR;
+    appendMany(log, total);
+    log.flush();
+
+    // Three full laps plus five sectors: sectors 0-4 were erased three times, the rest twice
+    for (uint32_t sector = 0; sector < SECTORS; sector++) {
+        TEST_ASSERT_EQUAL_UINT32(sector < 5 ? 3 : 2, fake::partitionErases(sector));
+    }
+    TEST_ASSERT_EQUAL_UINT32(total / AUDIT_BATCH_RECORDS, fake::partitionWrites());
+    // Sectors are erased only when the head reaches them, so a whole partition of history is kept
+    TEST_ASSERT_EQUAL_UINT32(SECTORS * PER_SECTOR, log.storedCount());
+    TEST_ASSERT_EQUAL_UINT32(total - SECTORS * PER_SECTOR, log.oldestSequence());
+    TEST_ASSERT_EQUAL_UINT32(total, log.nextSequence());
+
+    AuditRecord record;
+    TEST_ASSERT_EQUAL_UINT32(1, log.read(0, &record, 1)); // Overwritten sequences start at the oldest
+    TEST_ASSERT_EQUAL_UINT32(log.oldestSequence(), record.sequence);
+
+    AuditLog remounted;
+    remounted.begin();
+    TEST_ASSERT_EQUAL_UINT32(log.oldestSequence(), remounted.oldestSequence());
+    TEST_ASSERT_EQUAL_UINT32(total, remounted.nextSequence());
+}
+
+static void test_torn_write_is_detected_and_skipped() {
+    {
+        AuditLog log;
+        log.begin();
+        appendMany(log, AUDIT_BATCH_RECORDS);
+        appendMany(log, 3);
+        fake::cutPowerAfter(sizeof(AuditRecord) + 5); // Power fails inside the second record
+        log.flush();
+    }
+    AuditLog log;
+    log.begin();
+    TEST_ASSERT_EQUAL_UINT32(AUDIT_BATCH_RECORDS + 2, log.nextSequence());
+
+    AuditRecord records[2];
+    TEST_ASSERT_EQUAL_UINT32(2, log.read(AUDIT_BATCH_RECORDS, records, 2));
+    TEST_ASSERT_TRUE(AuditLog::isValid(records[0]));
+    TEST_ASSERT_FALSE(AuditLog::isValid(records[1]));
+
+    log.append(AuditEvent::Boot, nullptr, 0);
+    log.flush();
+    AuditRecord next;
+    log.read(AUDIT_BATCH_RECORDS + 2, &next, 1);
+    TEST_ASSERT_TRUE(AuditLog::isValid(next));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_reach_flash_in_batches);
+    RUN_TEST(test_log_continues_after_a_reboot);
+    RUN_TEST(test_wrapping_erases_every_sector_equally);
+    RUN_TEST(test_torn_write_is_detected_and_skipped);
+    return UNITY_END();
+}
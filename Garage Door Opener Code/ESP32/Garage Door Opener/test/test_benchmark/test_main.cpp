@@ -0,0 +1,114 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include <chrono>
+
+#include "AppState.h"
+#include "EventHandlers.h"
+#include "StatusDisplay.h"
+
+// Host-side cost of the hot paths, per handled event. The figures are for spotting regressions
+// between commits on the same machine, not ESP32 timings: the fakes stand in for the radio,
+// the SPI bus and NVS. Run with `pio test -e native -f test_benchmark -v` to see the report.
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t ITERATIONS = 20000;
+const uint8_t PHONE[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+
+struct Split {
+    Clock::duration callback{}; // BLE task side
+    Clock::duration handler{};  // loop task side
+};
+
+void drainBleEvents() {
+    BleEvent event;
+    while (bleEvents.pop(event)) handleBleEvent(event);
+}
+
+double nanosPerEvent(const Clock::duration total) {
+    return std::chrono::duration<double, std::nano>(total).count() / ITERATIONS;
+}
+
+void report(const char *name, const Split &split) {
+    char line[160];
+    snprintf(line, sizeof(line), "%-14s %8.0f ns/event (callback %6.0f ns, loop %6.0f ns)", name,
+             nanosPerEvent(split.callback + split.handler), nanosPerEvent(split.callback), nanosPerEvent(split.handler));
+    TEST_MESSAGE(line);
+}
+
+void report(const char *name, const Clock::duration total) {
+    char line[160];
+    snprintf(line, sizeof(line), "%-14s %8.0f ns/event", name, nanosPerEvent(total));
+    TEST_MESSAGE(line);
+}
+
+// Times `callback` on the BLE side and the loop() handling of what it posted, separately
+template <typename Callback>
+Split measure(Callback callback) {
+    Split split;
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        const Clock::time_point start = Clock::now();
+        callback();
+        const Clock::time_point posted = Clock::now();
+        drainBleEvents();
+        processCommands();
+        split.callback += posted - start;
+        split.handler += Clock::now() - posted;
+        if ((i & 0xFF) == 0) fake::clearSerialOutput();
+    }
+    return split;
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+    fake::addBond(PHONE);
+    setup();
+}
+
+void tearDown() {}
+
+static void benchmark_on_connect() {
+    const Split split = measure([] { fake::connect(PHONE); });
+    TEST_ASSERT_EQUAL_UINT32(0, bleEvents.droppedCount());
+    report("onConnect", split);
+}
+
+static void benchmark_on_write() {
+    // Status query: the full parse/post/execute/notify path without starting the relay
+    fake::connect(PHONE);
+    fake::authenticationComplete(PHONE, true);
+    drainBleEvents();
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_STATUS, 1, 0, 0};
+    const Split split = measure([&frame] {
+        fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    });
+    fake::clearNotifications();
+    report("onWrite", split);
+}
+
+static void benchmark_display_string() {
+    static const char *const TEXTS[] = {"COn 6ood", "SEC PASS"}; // Alternate so every flush sends digits
+    Clock::duration total{};
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        const Clock::time_point start = Clock::now();
+        displayString(TEXTS[i & 1], 0);
+        total += Clock::now() - start;
+        if ((i & 0xFF) == 0) {
+            fake::clearSerialOutput();
+            fake::clearSpi();
+        }
+    }
+    report("displayString", total);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(benchmark_on_connect);
+    RUN_TEST(benchmark_on_write);
+    RUN_TEST(benchmark_display_string);
+    return UNITY_END();
+}
@@ -0,0 +1,119 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "ButtonMonitor.h"
+
+namespace {
+constexpr uint8_t PIN = 13;
+constexpr unsigned long PAIRING_HOLD = 5000;
+constexpr unsigned long RESET_HOLD = 5000;
+
+// Polls like loop() does: everything due now, in order
+ButtonEvent pollOnce(ButtonMonitor &button) {
+    return button.poll(millis());
+}
+
+// Advances the clock to the next time the monitor wants to run and polls it
+ButtonEvent nextEvent(ButtonMonitor &button) {
+    for (int guard = 0; guard < 100; guard++) {
+        const ButtonEvent event = pollOnce(button);
+        if (event.type != ButtonEventType::None) return event;
+        const unsigned long wait = button.millisUntilNextPoll(millis());
+        if (wait == ULONG_MAX) break;
+        fake::advanceMillis(wait ? wait : 1);
+    }
+    return {ButtonEventType::None, 0};
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_edge_wakes_the_task() {
+    ButtonMonitor button(PIN, PAIRING_HOLD, RESET_HOLD);
+    button.begin(xTaskGetCurrentTaskHandle());
+
+    fake::setPin(PIN, HIGH);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::pendingNotifications());
+    TEST_ASSERT_EQUAL_UINT32(0, button.millisUntilNextPoll(millis()));
+}
+
+static void test_bounces_are_debounced_into_one_short_press() {
+    ButtonMonitor button(PIN, PAIRING_HOLD, RESET_HOLD);
+    button.begin(nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        fake::setPin(PIN, HIGH);
+        fake::advanceMillis(2);
+        fake::setPin(PIN, LOW);
+        fake::advanceMillis(2);
+    }
+    fake::setPin(PIN, HIGH);
+
+    const ButtonEvent countdown = nextEvent(button);
+    TEST_ASSERT_EQUAL(static_cast<int>(ButtonEventType::HoldCountdown), static_cast<int>(countdown.type));
+    TEST_ASSERT_EQUAL_UINT8(4, countdown.secondsRemaining);
+    TEST_ASSERT_TRUE(button.isPressed());
+
+    fake::advanceMillis(200);
+    fake::setPin(PIN, LOW);
+    TEST_ASSERT_EQUAL(static_cast<int>(ButtonEventType::ShortPress), static_cast<int>(nextEvent(button).type));
+    TEST_ASSERT_FALSE(button.isPressed());
+}
+
+static void test_hold_counts_down_to_pairing() {
+    ButtonMonitor button(PIN, PAIRING_HOLD, RESET_HOLD);
+    button.begin(nullptr);
+
+    fake::setPin(PIN, HIGH);
+    uint8_t countdowns = 0;
+    ButtonEvent event = nextEvent(button);
+    while (event.type == ButtonEventType::HoldCountdown) {
+        countdowns++;
+        event = nextEvent(button);
+    }
+    TEST_ASSERT_EQUAL(static_cast<int>(ButtonEventType::PairingHold), static_cast<int>(event.type));
+    TEST_ASSERT_EQUAL_UINT8(5, countdowns); // 4, 3, 2, 1, 0
+    TEST_ASSERT_FALSE(button.isResetHold());
+
+    // Releasing after the action completed reports nothing else
+    fake::setPin(PIN, LOW);
+    TEST_ASSERT_EQUAL(static_cast<int>(ButtonEventType::None), static_cast<int>(nextEvent(button).type));
+}
+
+static void test_press_held_at_boot_is_factory_reset() {
+    fake::setPin(PIN, HIGH);
+    ButtonMonitor button(PIN, PAIRING_HOLD, RESET_HOLD);
+    button.begin(nullptr);
+
+    ButtonEvent event = nextEvent(button);
+    TEST_ASSERT_TRUE(button.isResetHold());
+    while (event.type == ButtonEventType::HoldCountdown) event = nextEvent(button);
+    TEST_ASSERT_EQUAL(static_cast<int>(ButtonEventType::FactoryResetHold), static_cast<int>(event.type));
+}
+
+static void test_early_release_cancels_hold() {
+    ButtonMonitor button(PIN, PAIRING_HOLD, RESET_HOLD);
+    button.begin(nullptr);
+
+    fake::setPin(PIN, HIGH);
+    nextEvent(button);
+    fake::advanceMillis(2500);
+    while (pollOnce(button).type != ButtonEventType::None) {}
+    fake::setPin(PIN, LOW);
+    TEST_ASSERT_EQUAL(static_cast<int>(ButtonEventType::HoldCancelled), static_cast<int>(nextEvent(button).type));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_edge_wakes_the_task);
+    RUN_TEST(test_bounces_are_debounced_into_one_short_press);
+    RUN_TEST(test_hold_counts_down_to_pairing);
+    RUN_TEST(test_press_held_at_boot_is_factory_reset);
+    RUN_TEST(test_early_release_cancels_hold);
+    return UNITY_END();
+}
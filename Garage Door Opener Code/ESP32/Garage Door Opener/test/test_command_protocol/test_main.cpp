@@ -0,0 +1,92 @@
+#include <unity.h>
+
+#include "CommandProtocol.h"
+#include "EventQueue.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_text_command_is_not_binary() {
+    const uint8_t text[] = {'T', 'R', 'I', 'G', 'G', 'E', 'R'};
+    TEST_ASSERT_FALSE(FrameReader::isBinary(text, sizeof(text)));
+    TEST_ASSERT_FALSE(FrameReader::isBinary(text, 0));
+}
+
+static void test_reads_batched_frames_in_place() {
+    const uint8_t write[] = {
+        PROTOCOL_VERSION, OP_TRIGGER, 7, 0, 0,
+        PROTOCOL_VERSION, OP_STATUS, 8, FLAG_NO_REPLY, 2, 0xAA, 0xBB,
+    };
+    FrameReader reader(write, sizeof(write));
+    CommandView command{};
+
+    TEST_ASSERT_TRUE(reader.next(command));
+    TEST_ASSERT_EQUAL_UINT8(OP_TRIGGER, command.opcode);
+    TEST_ASSERT_EQUAL_UINT8(7, command.seq);
+    TEST_ASSERT_EQUAL_UINT8(0, command.length);
+
+    TEST_ASSERT_TRUE(reader.next(command));
+    TEST_ASSERT_EQUAL_UINT8(OP_STATUS, command.opcode);
+    TEST_ASSERT_EQUAL_UINT8(FLAG_NO_REPLY, command.flags);
+    TEST_ASSERT_EQUAL_UINT8(2, command.length);
+    TEST_ASSERT_TRUE(command.payload == write + 10); // Points into the write, no copy
+
+    TEST_ASSERT_FALSE(reader.next(command));
+    TEST_ASSERT_FALSE(reader.malformed());
+}
+
+static void test_truncated_frame_is_malformed() {
+    const uint8_t write[] = {PROTOCOL_VERSION, OP_STATUS, 9, 0, 4, 0x01};
+    FrameReader reader(write, sizeof(write));
+    CommandView command{};
+
+    TEST_ASSERT_FALSE(reader.next(command));
+    TEST_ASSERT_TRUE(reader.malformed());
+    TEST_ASSERT_EQUAL_UINT8(9, reader.lastSeq());
+}
+
+static void test_oversized_payload_does_not_fit_record() {
+    uint8_t write[FRAME_HEADER_SIZE + MAX_COMMAND_PAYLOAD + 1] = {PROTOCOL_VERSION, OP_STATUS, 3, 0, MAX_COMMAND_PAYLOAD + 1};
+    FrameReader reader(write, sizeof(write));
+    CommandView command{};
+    CommandRecord record{};
+
+    TEST_ASSERT_TRUE(reader.next(command));
+    TEST_ASSERT_FALSE(toRecord(command, record));
+    TEST_ASSERT_EQUAL_UINT8(3, record.seq);
+    TEST_ASSERT_EQUAL_UINT8(0, record.length);
+}
+
+static void test_reply_layout() {
+    const Reply reply = makeReply(42, OP_TRIGGER, STATUS_BUSY);
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&reply);
+    const uint8_t expected[] = {PROTOCOL_VERSION, 42, OP_TRIGGER, STATUS_BUSY, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, bytes, sizeof(expected));
+}
+
+static void test_ring_drops_when_full_and_tracks_high_water() {
+    SpscRing<uint32_t, 4> ring;
+    for (uint32_t i = 0; i < 5; i++) ring.push(i);
+
+    TEST_ASSERT_EQUAL_UINT32(4, ring.size());
+    TEST_ASSERT_EQUAL_UINT32(1, ring.droppedCount());
+    TEST_ASSERT_EQUAL_UINT32(4, ring.highWaterMark());
+
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value); // FIFO order, the overflowing item is the one lost
+    }
+    TEST_ASSERT_FALSE(ring.pop(value));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_text_command_is_not_binary);
+    RUN_TEST(test_reads_batched_frames_in_place);
+    RUN_TEST(test_truncated_frame_is_malformed);
+    RUN_TEST(test_oversized_payload_does_not_fit_record);
+    RUN_TEST(test_reply_layout);
+    RUN_TEST(test_ring_drops_when_full_and_tracks_high_water);
+    return UNITY_END();
+}
@@ -0,0 +1,92 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "Config.h"
+#include "ConnParamManager.h"
+
+namespace {
+const uint8_t PHONE[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+
+bool requested(const esp_ble_conn_update_params_t &request, const ConnProfile &profile) {
+    return request.min_int == profile.minInterval && request.max_int == profile.maxInterval &&
+           request.latency == profile.latency && request.timeout == profile.timeout;
+}
+
+const esp_ble_conn_update_params_t &lastRequest() {
+    return fake::connParamRequests().back();
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_link_starts_fast_and_idles_when_quiet() {
+    ConnParamManager manager;
+    manager.onAuthenticated(0, PHONE, 1000);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::connParamRequests().size());
+    TEST_ASSERT_TRUE(requested(lastRequest(), DEFAULT_FAST_PROFILE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(PHONE, lastRequest().bda, ESP_BD_ADDR_LEN);
+    TEST_ASSERT_EQUAL_UINT32(CONN_IDLE_AFTER_MILLIS, manager.millisUntilIdle(1000));
+
+    manager.idleDue(1000 + CONN_IDLE_AFTER_MILLIS - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::connParamRequests().size());
+    manager.idleDue(1000 + CONN_IDLE_AFTER_MILLIS);
+    TEST_ASSERT_EQUAL_UINT32(2, fake::connParamRequests().size());
+    TEST_ASSERT_TRUE(requested(lastRequest(), DEFAULT_IDLE_PROFILE));
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, manager.millisUntilIdle(1000 + CONN_IDLE_AFTER_MILLIS));
+}
+
+static void test_activity_returns_an_idle_link_to_fast() {
+    ConnParamManager manager;
+    manager.onAuthenticated(0, PHONE, 0);
+    manager.onActivity(0, 100); // Already fast, no new request
+    TEST_ASSERT_EQUAL_UINT32(1, fake::connParamRequests().size());
+
+    manager.idleDue(100 + CONN_IDLE_AFTER_MILLIS);
+    manager.onActivity(0, 200 + CONN_IDLE_AFTER_MILLIS);
+    TEST_ASSERT_EQUAL_UINT32(3, fake::connParamRequests().size());
+    TEST_ASSERT_TRUE(requested(lastRequest(), DEFAULT_FAST_PROFILE));
+    ConnProfileKind kind = ConnProfileKind::Idle;
+    TEST_ASSERT_TRUE(manager.currentProfile(0, kind));
+    TEST_ASSERT_TRUE(kind == ConnProfileKind::Fast);
+}
+
+static void test_device_override_survives_reconnect() {
+    const ConnProfile idle = {400, 800, 0, 1000};
+    ConnParamManager manager;
+    TEST_ASSERT_TRUE(manager.setProfile(PHONE, ConnProfileKind::Idle, idle));
+
+    manager.onAuthenticated(2, PHONE, 0);
+    manager.idleDue(CONN_IDLE_AFTER_MILLIS);
+    TEST_ASSERT_TRUE(requested(lastRequest(), idle));
+
+    manager.onDisconnected(2);
+    manager.resetProfile(PHONE, ConnProfileKind::Idle);
+    manager.onAuthenticated(2, PHONE, 0);
+    manager.idleDue(CONN_IDLE_AFTER_MILLIS);
+    TEST_ASSERT_TRUE(requested(lastRequest(), DEFAULT_IDLE_PROFILE));
+}
+
+static void test_out_of_spec_profiles_are_refused() {
+    ConnParamManager manager;
+    TEST_ASSERT_FALSE(manager.setProfile(PHONE, ConnProfileKind::Fast, {5, 12, 0, 200}));    // Interval below 7.5 ms
+    TEST_ASSERT_FALSE(manager.setProfile(PHONE, ConnProfileKind::Fast, {24, 12, 0, 200}));   // min > max
+    TEST_ASSERT_FALSE(manager.setProfile(PHONE, ConnProfileKind::Idle, {80, 160, 500, 600})); // Latency above 499
+    TEST_ASSERT_FALSE(manager.setProfile(PHONE, ConnProfileKind::Idle, {800, 800, 4, 600}));  // Timeout too short for the latency
+    TEST_ASSERT_TRUE(fake::connParamRequests().empty());
+    TEST_ASSERT_TRUE(ConnParamManager::isValid(DEFAULT_FAST_PROFILE));
+    TEST_ASSERT_TRUE(ConnParamManager::isValid(DEFAULT_IDLE_PROFILE));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_link_starts_fast_and_idles_when_quiet);
+    RUN_TEST(test_activity_returns_an_idle_link_to_fast);
+    RUN_TEST(test_device_override_survives_reconnect);
+    RUN_TEST(test_out_of_spec_profiles_are_refused);
+    return UNITY_END();
+}
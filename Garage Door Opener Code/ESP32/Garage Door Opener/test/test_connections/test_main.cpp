@@ -0,0 +1,109 @@
+#include <unity.h>
+
+#include "CommandQueue.h"
+#include "ConnectionTable.h"
+
+namespace {
+const uint8_t ADDRESS_A[ESP_BD_ADDR_LEN] = {1, 2, 3, 4, 5, 6};
+const uint8_t ADDRESS_B[ESP_BD_ADDR_LEN] = {1, 2, 3, 4, 5, 7};
+
+BleEvent command(const uint16_t connId, const uint8_t seq) {
+    BleEvent event{};
+    event.type = BleEventType::Command;
+    event.connId = connId;
+    event.command.opcode = OP_STATUS;
+    event.command.seq = seq;
+    return event;
+}
+} // namespace
+
+void setUp() {}
+void tearDown() {}
+
+static void test_table_is_keyed_by_conn_id_and_bounded() {
+    ConnectionTable table;
+    for (uint8_t i = 0; i < MAX_CONNECTIONS; i++) TEST_ASSERT_TRUE(table.add(i, ADDRESS_A, i));
+    TEST_ASSERT_TRUE(table.isFull());
+    TEST_ASSERT_FALSE(table.add(MAX_CONNECTIONS, ADDRESS_B, 0));
+
+    table.remove(1);
+    TEST_ASSERT_EQUAL_UINT8(MAX_CONNECTIONS - 1, table.count());
+    Connection connection{};
+    TEST_ASSERT_FALSE(table.find(1, connection));
+    TEST_ASSERT_TRUE(table.add(7, ADDRESS_B, 10));
+    TEST_ASSERT_TRUE(table.find(7, connection));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ADDRESS_B, connection.address, ESP_BD_ADDR_LEN);
+}
+
+static void test_pairing_candidate_is_newest_unauthenticated_link() {
+    ConnectionTable table;
+    table.add(0, ADDRESS_A, 100);
+    table.add(1, ADDRESS_B, 200);
+    uint16_t connId = 0xFF;
+
+    TEST_ASSERT_TRUE(table.pairingCandidate(connId));
+    TEST_ASSERT_EQUAL_UINT16(1, connId);
+
+    table.authenticate(1);
+    TEST_ASSERT_TRUE(table.isAuthenticated(1));
+    TEST_ASSERT_TRUE(table.pairingCandidate(connId));
+    TEST_ASSERT_EQUAL_UINT16(0, connId);
+
+    table.authenticate(0);
+    TEST_ASSERT_FALSE(table.pairingCandidate(connId));
+}
+
+static void test_encryption_spans_are_kept_per_link() {
+    ConnectionTable table;
+    table.add(0, ADDRESS_A, 100);
+    table.add(1, ADDRESS_B, 110);
+    table.encryptionRequested(0, 105);
+    table.encryptionRequested(1, 115); // Second phone connecting before the first authenticated
+
+    uint32_t requestedAt = 0;
+    TEST_ASSERT_TRUE(table.takeEncryptionRequestedAt(0, requestedAt));
+    TEST_ASSERT_EQUAL_UINT32(105, requestedAt);
+    TEST_ASSERT_FALSE(table.takeEncryptionRequestedAt(0, requestedAt)); // Recorded once
+    TEST_ASSERT_TRUE(table.takeEncryptionRequestedAt(1, requestedAt));
+    TEST_ASSERT_EQUAL_UINT32(115, requestedAt);
+
+    // A new link in a reused slot starts without a pending span
+    table.remove(0);
+    table.add(2, ADDRESS_A, 200);
+    TEST_ASSERT_FALSE(table.takeEncryptionRequestedAt(2, requestedAt));
+}
+
+static void test_queue_alternates_between_connections() {
+    CommandQueue queue;
+    for (uint8_t seq = 0; seq < 3; seq++) TEST_ASSERT_TRUE(queue.push(command(0, seq)));
+    TEST_ASSERT_TRUE(queue.push(command(5, 50)));
+    TEST_ASSERT_TRUE(queue.push(command(5, 51)));
+
+    const uint8_t expected[] = {0, 50, 1, 51, 2};
+    BleEvent event{};
+    for (const uint8_t seq : expected) {
+        TEST_ASSERT_TRUE(queue.pop(event));
+        TEST_ASSERT_EQUAL_UINT8(seq, event.command.seq);
+    }
+    TEST_ASSERT_FALSE(queue.pop(event));
+}
+
+static void test_queue_lane_limit_and_drop() {
+    CommandQueue queue;
+    for (uint8_t seq = 0; seq < CommandQueue::LANE_DEPTH; seq++) TEST_ASSERT_TRUE(queue.push(command(2, seq)));
+    TEST_ASSERT_FALSE(queue.push(command(2, 99)));
+    TEST_ASSERT_TRUE(queue.push(command(3, 0))); // Other connections are unaffected
+
+    queue.drop(2);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_table_is_keyed_by_conn_id_and_bounded);
+    RUN_TEST(test_pairing_candidate_is_newest_unauthenticated_link);
+    RUN_TEST(test_encryption_spans_are_kept_per_link);
+    RUN_TEST(test_queue_alternates_between_connections);
+    RUN_TEST(test_queue_lane_limit_and_drop);
+    return UNITY_END();
+}
@@ -0,0 +1,131 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "DeviceRegistry.h"
+
+namespace {
+// Addresses that differ only in the last byte, so several share an index slot
+void addressFor(const uint8_t n, esp_bd_addr_t address) {
+    const esp_bd_addr_t base = {0x10, 0x20, 0x30, 0x40, 0x50, 0x00};
+    memcpy(address, base, ESP_BD_ADDR_LEN);
+    address[5] = n;
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_every_device_is_found_after_removals() {
+    DeviceRegistry registry;
+    esp_bd_addr_t address;
+    for (uint8_t n = 0; n < MAX_BONDED_DEVICES; n++) {
+        addressFor(n, address);
+        TEST_ASSERT_TRUE(registry.touch(address));
+    }
+    addressFor(MAX_BONDED_DEVICES, address);
+    TEST_ASSERT_FALSE(registry.touch(address)); // Full
+    TEST_ASSERT_NULL(registry.find(address));
+
+    for (uint8_t n = 0; n < MAX_BONDED_DEVICES; n += 3) {
+        addressFor(n, address);
+        TEST_ASSERT_TRUE(registry.remove(address));
+        TEST_ASSERT_FALSE(registry.remove(address));
+    }
+    for (uint8_t n = 0; n < MAX_BONDED_DEVICES; n++) {
+        addressFor(n, address);
+        const DeviceRecord *record = registry.find(address);
+        if (n % 3 == 0) {
+            TEST_ASSERT_NULL(record);
+        } else {
+            TEST_ASSERT_NOT_NULL(record);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(address, record->address, ESP_BD_ADDR_LEN);
+            TEST_ASSERT_EQUAL_UINT32(n + 1, record->lastSeen);
+        }
+    }
+}
+
+static void test_changes_reach_nvs_in_one_write() {
+    BondAllowlist bonds;
+    esp_bd_addr_t phone;
+    addressFor(1, phone);
+    bonds.add(phone);
+
+    DeviceRegistry registry;
+    registry.load(bonds);
+    registry.touch(phone);
+    registry.setName(phone, reinterpret_cast<const uint8_t *>("kitchen"), 7);
+    for (uint8_t i = 0; i < 20; i++) registry.countTrigger(phone);
+    TEST_ASSERT_EQUAL_UINT32(0, registry.writeCount());
+
+    TEST_ASSERT_TRUE(registry.save());
+    TEST_ASSERT_TRUE(registry.save()); // Nothing new, nothing written
+    TEST_ASSERT_EQUAL_UINT32(1, registry.writeCount());
+
+    DeviceRegistry rebooted;
+    rebooted.load(bonds);
+    TEST_ASSERT_FALSE(rebooted.isDirty());
+    const DeviceRecord *record = rebooted.find(phone);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_UINT32(20, record->triggerCount);
+    TEST_ASSERT_EQUAL_MEMORY("kitchen", record->name, 7);
+    rebooted.touch(phone);
+    TEST_ASSERT_EQUAL_UINT32(2, rebooted.find(phone)->lastSeen); // The tick carries on across reboots
+}
+
+static void test_load_follows_the_bond_table() {
+    esp_bd_addr_t kept, dropped, added;
+    addressFor(1, kept);
+    addressFor(2, dropped);
+    addressFor(3, added);
+    BondAllowlist before;
+    before.add(kept);
+    before.add(dropped);
+    DeviceRegistry registry;
+    registry.load(before);
+    registry.touch(kept);
+    registry.touch(dropped);
+    registry.save();
+
+    BondAllowlist after;
+    after.add(kept);
+    after.add(added);
+    registry.load(after);
+    TEST_ASSERT_EQUAL_UINT8(2, registry.size());
+    TEST_ASSERT_EQUAL_UINT32(1, registry.find(kept)->lastSeen);
+    TEST_ASSERT_NULL(registry.find(dropped));
+    TEST_ASSERT_EQUAL_UINT32(0, registry.find(added)->lastSeen); // Never seen
+    TEST_ASSERT_TRUE(registry.isDirty());
+}
+
+static void test_least_recently_seen_skips_connected_devices() {
+    esp_bd_addr_t first, second, third;
+    addressFor(1, first);
+    addressFor(2, second);
+    addressFor(3, third);
+    DeviceRegistry registry;
+    registry.touch(first);
+    registry.touch(second);
+    registry.touch(third);
+    registry.touch(first);
+
+    ConnectionTable connections;
+    TEST_ASSERT_EQUAL_MEMORY(second, registry.leastRecentlySeen(connections)->address, ESP_BD_ADDR_LEN);
+    connections.add(0, second, 0);
+    TEST_ASSERT_EQUAL_MEMORY(third, registry.leastRecentlySeen(connections)->address, ESP_BD_ADDR_LEN);
+    connections.add(1, third, 0);
+    connections.add(2, first, 0);
+    TEST_ASSERT_NULL(registry.leastRecentlySeen(connections));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_device_is_found_after_removals);
+    RUN_TEST(test_changes_reach_nvs_in_one_write);
+    RUN_TEST(test_load_follows_the_bond_table);
+    RUN_TEST(test_least_recently_seen_skips_connected_devices);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "Max7219Display.h"
+
+namespace {
+constexpr uint8_t REG_DIGIT0 = 0x01;
+
+uint16_t digitFrame(const uint8_t digit, const uint8_t segments) {
+    return static_cast<uint16_t>((REG_DIGIT0 + digit) << 8 | segments);
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_begin_blanks_all_digits() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+
+    const std::vector<uint16_t> &frames = fake::spiFrames();
+    TEST_ASSERT_EQUAL_UINT32(13, frames.size()); // 5 control registers + 8 digits
+    for (uint8_t digit = 0; digit < MAX7219_DIGITS; digit++) {
+        TEST_ASSERT_EQUAL_HEX16(digitFrame(digit, 0), frames[5 + digit]);
+    }
+}
+
+static void test_text_drawn_before_begin_shows_once_begun() {
+    Max7219Display display(21, 18, 19);
+    display.setChar(0, '5', false);
+    TEST_ASSERT_EQUAL_UINT8(0, display.flush());
+    TEST_ASSERT_TRUE(fake::spiFrames().empty());
+
+    display.begin(6);
+    TEST_ASSERT_EQUAL_UINT32(14, fake::spiFrames().size()); // Blanking, then the pending digit
+    TEST_ASSERT_EQUAL_HEX16(digitFrame(0, Max7219Display::segmentsFor('5')), fake::spiFrames().back());
+}
+
+static void test_flush_sends_only_changed_digits_in_one_transaction() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+    fake::clearSpi();
+
+    display.setChar(7, 'P', false);
+    display.setChar(0, '1', true);
+    TEST_ASSERT_EQUAL_UINT8(2, display.flush());
+    TEST_ASSERT_EQUAL_UINT32(1, fake::spiTransactions());
+    TEST_ASSERT_EQUAL_UINT32(2, fake::spiFrames().size());
+    TEST_ASSERT_EQUAL_HEX16(digitFrame(0, Max7219Display::segmentsFor('1') | 0x80), fake::spiFrames()[0]);
+    TEST_ASSERT_EQUAL_HEX16(digitFrame(7, Max7219Display::segmentsFor('P')), fake::spiFrames()[1]);
+
+    // Redrawing the same content costs nothing on the bus
+    display.clear();
+    display.setChar(7, 'P', false);
+    display.setChar(0, '1', true);
+    TEST_ASSERT_EQUAL_UINT8(0, display.flush());
+    TEST_ASSERT_EQUAL_UINT32(1, fake::spiTransactions());
+    TEST_ASSERT_EQUAL_UINT32(1, display.timing().skippedFlushes);
+}
+
+static void test_set_column_touches_every_digit() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+    fake::clearSpi();
+
+    display.setColumn(1, true); // Segment A
+    TEST_ASSERT_EQUAL_UINT8(MAX7219_DIGITS, display.flush());
+    for (uint8_t digit = 0; digit < MAX7219_DIGITS; digit++) {
+        TEST_ASSERT_EQUAL_HEX16(digitFrame(digit, 0x40), fake::spiFrames()[digit]);
+    }
+}
+
+static void test_unknown_characters_are_blank() {
+    TEST_ASSERT_EQUAL_HEX8(0, Max7219Display::segmentsFor(static_cast<char>(0xC8)));
+    TEST_ASSERT_EQUAL_HEX8(0, Max7219Display::segmentsFor(' '));
+    TEST_ASSERT_EQUAL_HEX8(0x7E, Max7219Display::segmentsFor('0'));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_blanks_all_digits);
+    RUN_TEST(test_text_drawn_before_begin_shows_once_begun);
+    RUN_TEST(test_flush_sends_only_changed_digits_in_one_transaction);
+    RUN_TEST(test_set_column_touches_every_digit);
+    RUN_TEST(test_unknown_characters_are_blank);
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "DisplayEngine.h"
+
+namespace {
+constexpr uint8_t REG_DIGIT0 = 0x01;
+
+constexpr uint8_t TEXT[MAX7219_DIGITS] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+constexpr uint8_t PASSKEY[MAX7219_DIGITS] = {0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70};
+
+constexpr AnimationFrame SWEEP_FRAMES[] = {
+    {{0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40}, 40},
+    {{0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20}, 40},
+    {{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10}, 100},
+};
+constexpr Animation SWEEP = {SWEEP_FRAMES, 3, false};
+constexpr Animation SWEEP_LOOP = {SWEEP_FRAMES, 3, true};
+
+// What the chip holds in a digit register, from the last write the fake SPI bus saw
+uint8_t shown(const uint8_t digit) {
+    const std::vector<uint16_t> &frames = fake::spiFrames();
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+        if ((*frame >> 8) == REG_DIGIT0 + digit) return static_cast<uint8_t>(*frame);
+    }
+    return 0;
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_passkey_layer_covers_status_text_until_cleared() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+    DisplayEngine engine(display);
+
+    engine.show(DisplayLayer::Passkey, PASSKEY, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(0, engine.show(DisplayLayer::Status, TEXT, 5000, 10)); // Hidden, nothing sent
+    TEST_ASSERT_EQUAL_HEX8(PASSKEY[3], shown(3));
+
+    engine.clear(DisplayLayer::Passkey);
+    TEST_ASSERT_EQUAL_HEX8(TEXT[3], shown(3));
+    TEST_ASSERT_EQUAL_UINT32(4990, engine.millisUntilTick(20));
+}
+
+static void test_held_layer_expires_to_the_one_below() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+    DisplayEngine engine(display);
+
+    engine.play(DisplayLayer::Idle, SWEEP_LOOP, 0, 0);
+    engine.show(DisplayLayer::Status, TEXT, 1000, 0);
+    engine.tick(999);
+    TEST_ASSERT_TRUE(engine.isActive(DisplayLayer::Status));
+    TEST_ASSERT_EQUAL_HEX8(TEXT[0], shown(0));
+
+    engine.tick(1000); // Six 180 ms loops in, frame 2 runs 980..1080
+    TEST_ASSERT_FALSE(engine.isActive(DisplayLayer::Status));
+    TEST_ASSERT_EQUAL_HEX8(0x10, shown(0));
+    TEST_ASSERT_EQUAL_UINT32(80, engine.millisUntilTick(1000));
+}
+
+static void test_one_shot_animation_steps_through_its_frames_and_ends() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+    DisplayEngine engine(display);
+
+    engine.play(DisplayLayer::Status, SWEEP, 0, 100);
+    TEST_ASSERT_EQUAL_HEX8(0x40, shown(7));
+    TEST_ASSERT_EQUAL_UINT32(40, engine.millisUntilTick(100));
+
+    fake::clearSpi();
+    engine.tick(139);
+    TEST_ASSERT_TRUE(fake::spiFrames().empty()); // Not due yet, nothing re-sent
+    engine.tick(140);
+    TEST_ASSERT_EQUAL_HEX8(0x20, shown(7));
+    TEST_ASSERT_EQUAL_UINT32(MAX7219_DIGITS, fake::spiFrames().size());
+
+    engine.tick(280); // Late tick: both remaining frames have run out
+    TEST_ASSERT_FALSE(engine.isPlaying(DisplayLayer::Status, SWEEP));
+    TEST_ASSERT_EQUAL_HEX8(0, shown(7));
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, engine.millisUntilTick(280));
+}
+
+static void test_newer_content_cancels_a_running_animation() {
+    Max7219Display display(21, 18, 19);
+    display.begin(6);
+    DisplayEngine engine(display);
+
+    engine.play(DisplayLayer::Status, SWEEP_LOOP, 0, 0);
+    engine.show(DisplayLayer::Status, TEXT, 0, 50);
+    TEST_ASSERT_FALSE(engine.isPlaying(DisplayLayer::Status, SWEEP_LOOP));
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, engine.millisUntilTick(50));
+    engine.tick(500);
+    TEST_ASSERT_EQUAL_HEX8(TEXT[5], shown(5));
+
+    engine.play(DisplayLayer::Status, SWEEP_LOOP, 0, 500);
+    engine.clear(DisplayLayer::Status);
+    TEST_ASSERT_EQUAL_HEX8(0, shown(5));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_passkey_layer_covers_status_text_until_cleared);
+    RUN_TEST(test_held_layer_expires_to_the_one_below);
+    RUN_TEST(test_one_shot_animation_steps_through_its_frames_and_ends);
+    RUN_TEST(test_newer_content_cancels_a_running_animation);
+    return UNITY_END();
+}
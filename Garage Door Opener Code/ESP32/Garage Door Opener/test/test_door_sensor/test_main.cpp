@@ -0,0 +1,129 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "DoorSensor.h"
+
+namespace {
+constexpr uint8_t CLOSED_PIN = 27;
+constexpr uint8_t OPEN_PIN = 26;
+constexpr unsigned long TRAVEL = 20000;
+
+// Polls like loop() does until the state changes or nothing is pending any more
+bool nextChange(DoorSensor &door) {
+    for (int guard = 0; guard < 100; guard++) {
+        if (door.poll(millis())) return true;
+        const unsigned long wait = door.millisUntilNextPoll(millis());
+        if (wait == ULONG_MAX) break;
+        fake::advanceMillis(wait ? wait : 1);
+    }
+    return false;
+}
+
+void assertState(const DoorState expected, const DoorSensor &door) {
+    TEST_ASSERT_EQUAL(static_cast<int>(expected), static_cast<int>(door.state()));
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_no_sensor_is_unknown() {
+    DoorSensor door(-1, -1, TRAVEL);
+    door.begin(nullptr, millis());
+    door.onPulse(millis());
+
+    assertState(DoorState::Unknown, door);
+    TEST_ASSERT_FALSE(nextChange(door));
+}
+
+static void test_bounces_are_one_transition() {
+    fake::setPin(CLOSED_PIN, LOW);
+    DoorSensor door(CLOSED_PIN, -1, TRAVEL);
+    door.begin(xTaskGetCurrentTaskHandle(), millis());
+    assertState(DoorState::Closed, door);
+
+    for (int i = 0; i < 3; i++) {
+        fake::setPin(CLOSED_PIN, HIGH);
+        fake::advanceMillis(5);
+        fake::setPin(CLOSED_PIN, LOW);
+        fake::advanceMillis(5);
+    }
+    TEST_ASSERT_TRUE(fake::pendingNotifications() > 0);
+    TEST_ASSERT_FALSE(nextChange(door)); // Settled back where it was
+    assertState(DoorState::Closed, door);
+    TEST_ASSERT_EQUAL_UINT8(0, door.transitions());
+}
+
+static void test_single_switch_opens_through_moving() {
+    fake::setPin(CLOSED_PIN, LOW);
+    DoorSensor door(CLOSED_PIN, -1, TRAVEL);
+    door.begin(nullptr, millis());
+
+    door.onPulse(millis());
+    fake::advanceMillis(1000);
+    fake::setPin(CLOSED_PIN, HIGH);
+    TEST_ASSERT_TRUE(nextChange(door));
+    assertState(DoorState::Moving, door);
+
+    // Not closed is all one switch knows once the travel time is up
+    TEST_ASSERT_TRUE(nextChange(door));
+    assertState(DoorState::Open, door);
+    TEST_ASSERT_EQUAL_UINT8(2, door.transitions());
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, door.millisUntilNextPoll(millis()));
+}
+
+static void test_two_switches_fault_when_the_door_stops_between() {
+    fake::setPin(CLOSED_PIN, LOW);
+    fake::setPin(OPEN_PIN, HIGH);
+    DoorSensor door(CLOSED_PIN, OPEN_PIN, TRAVEL);
+    door.begin(nullptr, millis());
+
+    fake::setPin(CLOSED_PIN, HIGH);
+    TEST_ASSERT_TRUE(nextChange(door));
+    assertState(DoorState::Moving, door);
+    const unsigned long left = millis();
+
+    TEST_ASSERT_TRUE(nextChange(door));
+    assertState(DoorState::Fault, door);
+    TEST_ASSERT_TRUE(millis() - left <= TRAVEL);
+
+    // Reaching a limit later clears the fault
+    fake::setPin(OPEN_PIN, LOW);
+    TEST_ASSERT_TRUE(nextChange(door));
+    assertState(DoorState::Open, door);
+}
+
+static void test_pulse_that_never_leaves_the_limit_is_a_fault() {
+    fake::setPin(CLOSED_PIN, LOW);
+    DoorSensor door(CLOSED_PIN, -1, TRAVEL);
+    door.begin(nullptr, millis());
+
+    door.onPulse(millis());
+    TEST_ASSERT_EQUAL_UINT32(TRAVEL, door.millisUntilNextPoll(millis()));
+    TEST_ASSERT_TRUE(nextChange(door));
+    assertState(DoorState::Fault, door);
+}
+
+static void test_both_limits_at_once_is_a_fault() {
+    fake::setPin(CLOSED_PIN, LOW);
+    fake::setPin(OPEN_PIN, LOW);
+    DoorSensor door(CLOSED_PIN, OPEN_PIN, TRAVEL);
+    door.begin(nullptr, millis());
+
+    assertState(DoorState::Fault, door);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_sensor_is_unknown);
+    RUN_TEST(test_bounces_are_one_transition);
+    RUN_TEST(test_single_switch_opens_through_moving);
+    RUN_TEST(test_two_switches_fault_when_the_door_stops_between);
+    RUN_TEST(test_pulse_that_never_leaves_the_limit_is_a_fault);
+    RUN_TEST(test_both_limits_at_once_is_a_fault);
+    return UNITY_END();
+}
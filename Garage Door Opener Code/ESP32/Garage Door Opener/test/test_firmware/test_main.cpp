@@ -0,0 +1,834 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "AppState.h"
+#include "BleBackend.h"
+#include "EventHandlers.h"
+#include "StatusDisplay.h"
+
+// End-to-end runs of setup()/loop() against the fakes: BLE callbacks fire inline, loop()
+// sleeps on the virtual clock, the relay and the display are observed through the fakes.
+
+namespace {
+const uint8_t PHONE[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+const uint8_t SECOND_PHONE[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x61};
+const uint8_t STRANGER[ESP_BD_ADDR_LEN] = {0xDE, 0xAD, 0xBE, 0xEF, 0x00, 0x01};
+
+// Runs loop() until the virtual clock has moved `millis` forward
+void runFor(const uint32_t millis) {
+    const uint64_t end = fake::nowMicros() + static_cast<uint64_t>(millis) * 1000;
+    while (fake::nowMicros() < end) {
+        const uint64_t before = fake::nowMicros();
+        loop();
+        // loop() returns without sleeping when nothing is scheduled; step the clock ourselves
+        if (fake::nowMicros() == before) fake::advanceMillis(1);
+    }
+}
+
+// Firmware globals outlive fake::reset(), put the ones a test can leave behind back to idle
+void resetFirmwareState() {
+    for (uint8_t slot = 0; slot < Scheduler::MAX_TIMERS; slot++) scheduler.cancel(slot);
+    BleEvent event;
+    while (bleEvents.pop(event)) {}
+    while (commandQueue.pop(event)) {}
+    connections.clear();
+    connParams = ConnParamManager{};
+    auditLog = AuditLog{};
+    deviceRegistry = DeviceRegistry{};
+    bootTimeline = BootTimeline{};
+    pairingModeActive = false;
+    allowNewPairing = false;
+    currentDisplayedPasskey = 0;
+    for (uint8_t layer = 0; layer < static_cast<uint8_t>(DisplayLayer::Count); layer++) {
+        displayEngine.clear(static_cast<DisplayLayer>(layer));
+    }
+    memset(bleEventCounts, 0, sizeof(bleEventCounts));
+}
+
+Reply lastReply() {
+    Reply reply{};
+    const std::string &value = fake::notifications().back().value;
+    TEST_ASSERT_EQUAL_UINT32(sizeof(Reply), value.size());
+    memcpy(&reply, value.data(), sizeof(Reply));
+    return reply;
+}
+
+// Connects a bonded phone, lets it finish encryption and enable notifications like an app does
+void connectAuthenticated(const uint8_t address[ESP_BD_ADDR_LEN], const uint16_t connId = 0) {
+    fake::connect(address, connId);
+    fake::authenticationComplete(address, true);
+    fake::subscribe(CHARACTERISTIC_UUID, true, connId);
+    runFor(10);
+}
+
+Reply replyAt(const size_t index) {
+    Reply reply{};
+    memcpy(&reply, fake::notifications()[index].value.data(), sizeof(Reply));
+    return reply;
+}
+
+// Sets the closed limit switch and lets it debounce, one loop() door step at a time: loop()
+// itself would sleep through to the pending notification
+void moveDoor(const uint8_t level) {
+    fake::setPin(DOOR_CLOSED_PIN, level);
+    fake::advanceMillis(60);
+    if (doorSensor.poll(millis())) handleDoorChange();
+}
+
+bool notified(const char *text) {
+    for (const fake::Notification &notification : fake::notifications()) {
+        if (notification.value == text) return true;
+    }
+    return false;
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+    resetFirmwareState();
+    fake::addBond(PHONE);
+    fake::addBond(SECOND_PHONE);
+    setup();
+}
+
+void tearDown() {
+    runFor(6000); // Let the relay pulse, animations and status text run out
+}
+
+static void test_bonded_device_connects_and_is_encrypted() {
+    fake::connect(PHONE);
+    TEST_ASSERT_TRUE(fake::disconnectRequests().empty());
+    TEST_ASSERT_EQUAL_UINT32(1, fake::encryptionRequests());
+
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT8(1, connections.count());
+    TEST_ASSERT_FALSE(connections.isAuthenticated(0));
+    TEST_ASSERT_EQUAL_UINT32(1, bleEventCounts[static_cast<uint8_t>(BleEventType::Connected)]);
+
+    fake::authenticationComplete(PHONE, true);
+    TEST_ASSERT_TRUE(connections.isAuthenticated(0));
+}
+
+static void test_controller_filters_unknown_devices_outside_pairing() {
+    TEST_ASSERT_EQUAL_UINT32(2, fake::whitelist().size());
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+    TEST_ASSERT_TRUE(fake::advertising()->connectFilter);
+
+    const uint32_t rejectedBefore = telemetry.get(COUNTER_REJECTED_CONNECTIONS);
+    TEST_ASSERT_FALSE(fake::connect(STRANGER, 3));
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT8(0, connections.count());
+    TEST_ASSERT_TRUE(fake::disconnectRequests().empty());
+    TEST_ASSERT_EQUAL_UINT32(rejectedBefore, telemetry.get(COUNTER_REJECTED_CONNECTIONS));
+    TEST_ASSERT_TRUE(fake::connect(PHONE));
+}
+
+static void test_unknown_device_is_disconnected_when_whitelist_is_too_small() {
+    // More bonds than whitelist entries: advertising stays open and onConnect does the filtering
+    fake::reset();
+    resetFirmwareState();
+    fake::addBond(PHONE);
+    fake::addBond(SECOND_PHONE);
+    fake::setWhitelistCapacity(1);
+    setup();
+    TEST_ASSERT_FALSE(fake::advertising()->connectFilter);
+
+    const uint32_t rejectedBefore = telemetry.get(COUNTER_REJECTED_CONNECTIONS);
+    TEST_ASSERT_TRUE(fake::connect(STRANGER, 3));
+
+    TEST_ASSERT_EQUAL_UINT32(1, fake::disconnectRequests().size());
+    TEST_ASSERT_EQUAL_UINT16(3, fake::disconnectRequests()[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, fake::encryptionRequests());
+    TEST_ASSERT_EQUAL_UINT32(rejectedBefore + 1, telemetry.get(COUNTER_REJECTED_CONNECTIONS));
+}
+
+static void test_text_trigger_pulses_relay() {
+    connectAuthenticated(PHONE);
+    fake::write(CHARACTERISTIC_UUID, "TRIGGER", PHONE);
+    TEST_ASSERT_EQUAL_INT(LOW, fake::pinLevel(RELAY_PIN)); // Nothing happens on the BLE task
+
+    runFor(10);
+    TEST_ASSERT_TRUE(notified("Command accepted"));
+    TEST_ASSERT_EQUAL_INT(HIGH, fake::pinLevel(RELAY_PIN));
+    TEST_ASSERT_TRUE(notified("Relay energized"));
+
+    runFor(RELAY_PULSE_MILLIS);
+    TEST_ASSERT_EQUAL_INT(LOW, fake::pinLevel(RELAY_PIN));
+    TEST_ASSERT_TRUE(notified("Relay released"));
+}
+
+static void test_binary_trigger_reports_progress() {
+    connectAuthenticated(PHONE);
+    const uint8_t frames[] = {
+        PROTOCOL_VERSION, OP_TRIGGER, 21, 0, 0,
+        PROTOCOL_VERSION, OP_TRIGGER, 22, 0, 0,
+    };
+    fake::write(CHARACTERISTIC_UUID, frames, sizeof(frames), PHONE);
+    runFor(10);
+
+    // First trigger accepted and energized, the second one joins the same pulse
+    bool accepted = false, coalesced = false, energized = false;
+    for (const fake::Notification &notification : fake::notifications()) {
+        if (notification.value.size() != sizeof(Reply)) continue;
+        Reply reply{};
+        memcpy(&reply, notification.value.data(), sizeof(Reply));
+        accepted |= reply.seq == 21 && reply.status == STATUS_ACCEPTED;
+        coalesced |= reply.seq == 22 && reply.status == STATUS_COALESCED;
+        energized |= reply.seq == 21 && reply.status == STATUS_ENERGIZED;
+    }
+    TEST_ASSERT_TRUE(accepted);
+    TEST_ASSERT_TRUE(coalesced);
+    TEST_ASSERT_TRUE(energized);
+
+    runFor(RELAY_PULSE_MILLIS);
+    const Reply released = lastReply();
+    TEST_ASSERT_EQUAL_UINT8(21, released.seq);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_RELEASED, released.status);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, telemetry.histogram(HIST_WRITE_TO_RELAY).count);
+}
+
+static void test_status_reply_reports_bonds_and_pulse_length() {
+    connectAuthenticated(PHONE);
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_STATUS, 5, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(10);
+
+    const Reply reply = lastReply();
+    TEST_ASSERT_EQUAL_UINT8(STATUS_OK, reply.status);
+    TEST_ASSERT_EQUAL_UINT8(STATE_CONNECTED, reply.data[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, reply.data[1]);
+    TEST_ASSERT_EQUAL_UINT32(RELAY_PULSE_MILLIS, reply.data[2] | reply.data[3] << 8);
+}
+
+static void test_pairing_hold_opens_window_and_bonds_new_device() {
+    fake::setPin(BUTTON_PIN, HIGH);
+    runFor(PAIRING_PRESS_DURATION_MILLIS + 100);
+    fake::setPin(BUTTON_PIN, LOW);
+    runFor(100);
+    TEST_ASSERT_TRUE(pairingModeActive);
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+    TEST_ASSERT_FALSE(fake::advertising()->connectFilter);
+
+    TEST_ASSERT_TRUE(fake::connect(STRANGER));
+    TEST_ASSERT_TRUE(fake::disconnectRequests().empty());
+    TEST_ASSERT_TRUE(fake::securityRequest());
+    fake::passKeyNotify(123456);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT32(123456, currentDisplayedPasskey);
+    TEST_ASSERT_TRUE(displayEngine.isActive(DisplayLayer::Passkey));
+
+    fake::authenticationComplete(STRANGER, true);
+    runFor(10);
+    TEST_ASSERT_TRUE(bondAllowlist.contains(STRANGER));
+    TEST_ASSERT_FALSE(pairingModeActive);
+    TEST_ASSERT_EQUAL_UINT32(0, currentDisplayedPasskey);
+    TEST_ASSERT_FALSE(displayEngine.isActive(DisplayLayer::Passkey));
+    // Back to filtered advertising, with the new bond let through by the controller
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+    TEST_ASSERT_TRUE(fake::advertising()->connectFilter);
+    TEST_ASSERT_EQUAL_UINT32(3, fake::whitelist().size());
+}
+
+static void test_only_a_new_bond_is_audited_as_paired() {
+    runFor(10);
+    const auto pairedRecords = []() {
+        auditLog.flush();
+        AuditRecord records[64];
+        const size_t count = auditLog.read(auditLog.oldestSequence(), records, 64);
+        uint32_t paired = 0;
+        for (size_t i = 0; i < count; i++) paired += records[i].event == static_cast<uint8_t>(AuditEvent::Paired);
+        return paired;
+    };
+    const auto openWindow = []() {
+        fake::setPin(BUTTON_PIN, HIGH);
+        runFor(PAIRING_PRESS_DURATION_MILLIS + 100);
+        fake::setPin(BUTTON_PIN, LOW);
+        runFor(100);
+        TEST_ASSERT_TRUE(pairingModeActive);
+    };
+
+    // A bonded phone re-encrypting while the window is open
+    openWindow();
+    connectAuthenticated(PHONE, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, pairedRecords());
+
+    openWindow();
+    TEST_ASSERT_TRUE(fake::connect(STRANGER, 1));
+    fake::passKeyNotify(123456);
+    fake::authenticationComplete(STRANGER, true);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT32(1, pairedRecords());
+}
+
+static void test_pairing_window_times_out() {
+    fake::setPin(BUTTON_PIN, HIGH);
+    runFor(PAIRING_PRESS_DURATION_MILLIS + 100);
+    fake::setPin(BUTTON_PIN, LOW);
+    TEST_ASSERT_TRUE(pairingModeActive);
+
+    runFor(PAIRING_WINDOW_TIMEOUT_MILLIS);
+    TEST_ASSERT_FALSE(pairingModeActive);
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+    TEST_ASSERT_TRUE(fake::advertising()->connectFilter);
+    TEST_ASSERT_FALSE(fake::connect(STRANGER));
+}
+
+static void test_security_request_rejected_outside_pairing() {
+    fake::connect(PHONE);
+    TEST_ASSERT_FALSE(fake::securityRequest());
+    TEST_ASSERT_EQUAL_UINT32(1, fake::disconnectRequests().size());
+}
+
+static void test_unauthenticated_connection_cannot_trigger() {
+    fake::connect(PHONE);
+    fake::subscribe(CHARACTERISTIC_UUID);
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_TRIGGER, 4, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(10);
+
+    TEST_ASSERT_EQUAL_UINT8(STATUS_NOT_AUTHORIZED, lastReply().status);
+    TEST_ASSERT_FALSE(actuator.isBusy());
+}
+
+static void test_advertising_continues_below_connection_limit() {
+    connectAuthenticated(PHONE, 0);
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+
+    connectAuthenticated(SECOND_PHONE, 1);
+    TEST_ASSERT_TRUE(fake::disconnectRequests().empty());
+    TEST_ASSERT_EQUAL_UINT8(2, connections.count());
+}
+
+static void test_replies_go_only_to_the_requesting_connection() {
+    connectAuthenticated(PHONE, 0);
+    connectAuthenticated(SECOND_PHONE, 1);
+    fake::clearNotifications();
+
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_STATUS, 8, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), SECOND_PHONE, 1);
+    runFor(10);
+
+    TEST_ASSERT_EQUAL_UINT32(1, fake::notifications().size());
+    TEST_ASSERT_EQUAL_UINT16(1, fake::notifications()[0].connId);
+}
+
+static void test_triggers_inside_pulse_window_coalesce() {
+    connectAuthenticated(PHONE, 0);
+    connectAuthenticated(SECOND_PHONE, 1);
+    fake::clearNotifications();
+    const uint32_t relayWritesBefore = fake::pinWriteCount(RELAY_PIN);
+
+    const uint8_t first[] = {PROTOCOL_VERSION, OP_TRIGGER, 1, 0, 0};
+    const uint8_t second[] = {PROTOCOL_VERSION, OP_TRIGGER, 2, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, first, sizeof(first), PHONE, 0);
+    fake::write(CHARACTERISTIC_UUID, second, sizeof(second), SECOND_PHONE, 1);
+    runFor(RELAY_PULSE_MILLIS + 10);
+
+    TEST_ASSERT_EQUAL_UINT32(2, fake::pinWriteCount(RELAY_PIN) - relayWritesBefore); // One on, one off
+    TEST_ASSERT_EQUAL_UINT8(STATUS_ACCEPTED, replyAt(0).status);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_COALESCED, replyAt(1).status);
+    TEST_ASSERT_NOT_EQUAL(fake::notifications()[0].connId, fake::notifications()[1].connId);
+
+    // Both requesters hear about the single pulse
+    uint8_t released = 0;
+    for (size_t i = 0; i < fake::notifications().size(); i++) {
+        if (replyAt(i).status == STATUS_RELEASED) released++;
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, released);
+}
+
+static void test_batched_commands_take_turns_with_other_connections() {
+    connectAuthenticated(PHONE, 0);
+    connectAuthenticated(SECOND_PHONE, 1);
+    fake::clearNotifications();
+
+    uint8_t burst[4 * FRAME_HEADER_SIZE];
+    for (uint8_t i = 0; i < 4; i++) {
+        const uint8_t frame[] = {PROTOCOL_VERSION, OP_STATUS, static_cast<uint8_t>(10 + i), 0, 0};
+        memcpy(burst + i * FRAME_HEADER_SIZE, frame, FRAME_HEADER_SIZE);
+    }
+    const uint8_t single[] = {PROTOCOL_VERSION, OP_STATUS, 99, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, burst, sizeof(burst), PHONE, 0);
+    fake::write(CHARACTERISTIC_UUID, single, sizeof(single), SECOND_PHONE, 1);
+    runFor(10);
+
+    TEST_ASSERT_EQUAL_UINT32(5, fake::notifications().size());
+    TEST_ASSERT_TRUE(replyAt(0).seq == 99 || replyAt(1).seq == 99); // Not stuck behind the whole burst
+}
+
+static void test_full_writes_from_every_link_fit_the_event_ring() {
+    const uint8_t third[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x62};
+    const uint8_t *phones[MAX_CONNECTIONS] = {PHONE, SECOND_PHONE, third};
+    fake::reset();
+    resetFirmwareState();
+    for (const uint8_t *phone : phones) fake::addBond(phone);
+    setup();
+    for (uint16_t connId = 0; connId < MAX_CONNECTIONS; connId++) connectAuthenticated(phones[connId], connId);
+    fake::clearNotifications();
+    const uint32_t droppedBefore = bleEvents.droppedCount();
+
+    // Each link sends a full write before loop() gets to run
+    uint8_t burst[MAX_COMMANDS_PER_WRITE * FRAME_HEADER_SIZE];
+    for (uint8_t i = 0; i < MAX_COMMANDS_PER_WRITE; i++) {
+        const uint8_t frame[] = {PROTOCOL_VERSION, OP_STATUS, i, 0, 0};
+        memcpy(burst + i * FRAME_HEADER_SIZE, frame, FRAME_HEADER_SIZE);
+    }
+    for (uint16_t connId = 0; connId < MAX_CONNECTIONS; connId++) {
+        fake::write(CHARACTERISTIC_UUID, burst, sizeof(burst), phones[connId], connId);
+    }
+    runFor(100);
+
+    TEST_ASSERT_EQUAL_UINT32(droppedBefore, bleEvents.droppedCount());
+    TEST_ASSERT_EQUAL_UINT32(MAX_CONNECTIONS * MAX_COMMANDS_PER_WRITE, fake::notifications().size());
+}
+
+static void test_rejected_pairing_drops_the_pairing_link_only() {
+    fake::connect(SECOND_PHONE, 1); // Still unauthenticated when the request arrives
+    connectAuthenticated(PHONE, 0);
+
+    TEST_ASSERT_FALSE(fake::securityRequest());
+    TEST_ASSERT_EQUAL_UINT32(1, fake::disconnectRequests().size());
+    TEST_ASSERT_EQUAL_UINT16(1, fake::disconnectRequests()[0]);
+}
+
+static void test_stats_characteristic_exports_telemetry() {
+    connectAuthenticated(PHONE);
+    const std::string blob = fake::read(STATS_CHARACTERISTIC_UUID);
+    TEST_ASSERT_EQUAL_UINT32(Telemetry::serializedSize(), blob.size());
+    TEST_ASSERT_TRUE(scheduler.isScheduled(TIMER_STATS_REFRESH));
+    TEST_ASSERT_EQUAL_UINT32(ESP_GATT_PERM_READ_ENC_MITM,
+                             fake::characteristic(STATS_CHARACTERISTIC_UUID)->getAccessPermissions());
+
+    // Refreshed by loop() while a link is up, not by the read
+    fake::disconnect(PHONE);
+    runFor(STATS_REFRESH_MILLIS + 10);
+    TEST_ASSERT_FALSE(scheduler.isScheduled(TIMER_STATS_REFRESH));
+}
+
+static void test_connection_profile_follows_activity() {
+    connectAuthenticated(PHONE);
+    TEST_ASSERT_EQUAL_UINT16(DEFAULT_FAST_PROFILE.maxInterval, fake::connParamRequests().back().max_int);
+
+    runFor(CONN_IDLE_AFTER_MILLIS + 10);
+    TEST_ASSERT_EQUAL_UINT16(DEFAULT_IDLE_PROFILE.maxInterval, fake::connParamRequests().back().max_int);
+    TEST_ASSERT_EQUAL_UINT16(DEFAULT_IDLE_PROFILE.latency, fake::connParamRequests().back().latency);
+
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_STATUS, 1, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT16(DEFAULT_FAST_PROFILE.maxInterval, fake::connParamRequests().back().max_int);
+
+    const uint32_t updatesBefore = telemetry.get(COUNTER_CONN_PARAM_UPDATES);
+    fake::connParamsUpdated(PHONE, 12, 0, 200);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT32(updatesBefore + 1, telemetry.get(COUNTER_CONN_PARAM_UPDATES));
+    BleConnParams negotiated{};
+    TEST_ASSERT_TRUE(connParams.negotiated(0, negotiated));
+    TEST_ASSERT_EQUAL_UINT16(12, negotiated.interval);
+}
+
+static void test_conn_profile_command_tunes_the_sender() {
+    connectAuthenticated(PHONE);
+    fake::connParamsUpdated(PHONE, 12, 0, 200);
+    // Idle profile: 500-1000 ms, no latency, 10 s timeout
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_CONN_PROFILE, 7, 0, 8, 1, 0x90, 0x01, 0x20, 0x03, 0, 0xE8, 0x03};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(10);
+    const Reply reply = lastReply();
+    TEST_ASSERT_EQUAL_UINT8(STATUS_OK, reply.status);
+    TEST_ASSERT_EQUAL_UINT8(12, reply.data[0]);
+
+    runFor(CONN_IDLE_AFTER_MILLIS + 10);
+    TEST_ASSERT_EQUAL_UINT16(400, fake::connParamRequests().back().min_int);
+    TEST_ASSERT_EQUAL_UINT16(1000, fake::connParamRequests().back().timeout);
+
+    const uint8_t invalid[] = {PROTOCOL_VERSION, OP_CONN_PROFILE, 8, 0, 8, 0, 0x01, 0x00, 0x01, 0x00, 0, 0xC8, 0x00};
+    fake::write(CHARACTERISTIC_UUID, invalid, sizeof(invalid), PHONE);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_INVALID_PARAM, lastReply().status);
+}
+
+static void test_boot_advertises_before_deferred_work() {
+    fake::reset();
+    resetFirmwareState();
+    fake::addBond(PHONE);
+    fake::advanceMillis(20); // Time spent before setup() in the ROM and bootloader
+    setup();
+
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+    TEST_ASSERT_TRUE(fake::spiFrames().empty()); // Display not brought up yet
+    TEST_ASSERT_EQUAL_UINT32(0, bootTimeline.at(BOOT_DEFERRED_DONE));
+    TEST_ASSERT_EQUAL_UINT32(20000, bootTimeline.at(BOOT_SETUP));
+    TEST_ASSERT_TRUE(bootTimeline.at(BOOT_ADVERTISING) >= bootTimeline.at(BOOT_GATT_READY));
+
+    fake::advanceMillis(1);
+    loop();
+    TEST_ASSERT_FALSE(fake::spiFrames().empty());
+    TEST_ASSERT_TRUE(bootTimeline.at(BOOT_DEFERRED_DONE) > bootTimeline.at(BOOT_ADVERTISING));
+    TEST_ASSERT_TRUE(fake::serialOutput().find("Boot timeline") != std::string::npos);
+
+    refreshTelemetryGauges();
+    TEST_ASSERT_EQUAL_UINT32(bootTimeline.at(BOOT_ADVERTISING), telemetry.get(COUNTER_BOOT_ADVERTISING_US));
+
+    // The backend footprint, for comparing the Bluedroid and NimBLE builds
+    TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(BleBackendKind::Bluedroid), telemetry.get(COUNTER_BLE_BACKEND));
+    TEST_ASSERT_EQUAL_UINT32(ESP.getSketchSize(), telemetry.get(COUNTER_FLASH_IMAGE_BYTES));
+    TEST_ASSERT_TRUE(telemetry.get(COUNTER_BLE_INIT_US) <= bootTimeline.at(BOOT_BLE_READY) - bootTimeline.at(BOOT_SETUP));
+    TEST_ASSERT_TRUE(fake::serialOutput().find("Bluedroid up in") != std::string::npos);
+}
+
+static void test_numbers_are_formatted_without_string() {
+    runFor(10); // Deferred init brings the display up
+    displayIdleStop(); // Heartbeat off, so only the digits of the text change
+    fake::clearSpi();
+    displayString(4052u, 0);
+    const std::vector<uint16_t> &frames = fake::spiFrames();
+    TEST_ASSERT_EQUAL_UINT32(4, frames.size());
+    const char expected[] = "4052";
+    for (uint8_t i = 0; i < 4; i++) {
+        const uint8_t digit = 7 - i; // Left aligned from the first digit, flushed lowest digit first
+        TEST_ASSERT_EQUAL_HEX16((digit + 1) << 8 | Max7219Display::segmentsFor(expected[i]), frames[3 - i]);
+    }
+}
+
+static void test_idle_heartbeat_runs_while_nobody_is_connected() {
+    runFor(10);
+    TEST_ASSERT_TRUE(displayEngine.isActive(DisplayLayer::Idle));
+
+    connectAuthenticated(PHONE);
+    TEST_ASSERT_FALSE(displayEngine.isActive(DisplayLayer::Idle));
+    TEST_ASSERT_TRUE(displayEngine.isActive(DisplayLayer::Status)); // "COn 6ood"
+
+    fake::disconnect(PHONE);
+    runFor(10);
+    TEST_ASSERT_TRUE(displayEngine.isActive(DisplayLayer::Idle)); // Under the status text until it runs out
+}
+
+static void test_heap_block_count_holds_after_boot() {
+    runFor(10);
+    for (int i = 0; i < 20; i++) {
+        connectAuthenticated(PHONE);
+        const uint8_t frame[] = {PROTOCOL_VERSION, OP_TRIGGER, static_cast<uint8_t>(i), 0, 0};
+        fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+        runFor(RELAY_PULSE_MILLIS + 100);
+        fake::disconnect(PHONE);
+        runFor(READVERTISE_DELAY_MILLIS + 10);
+    }
+    refreshTelemetryGauges();
+    TEST_ASSERT_EQUAL_UINT32(telemetry.get(COUNTER_HEAP_BOOT_BLOCKS), telemetry.get(COUNTER_HEAP_ALLOCATED_BLOCKS));
+    TEST_ASSERT_TRUE(telemetry.get(COUNTER_HEAP_LARGEST_BLOCK) > 0);
+}
+
+static void test_relay_sweep_is_stepped_by_the_scheduler() {
+    connectAuthenticated(PHONE);
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_TRIGGER, 1, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(10);
+    TEST_ASSERT_TRUE(knightRiderActive());
+
+    // loop() keeps serving commands mid-sweep
+    const uint8_t status[] = {PROTOCOL_VERSION, OP_STATUS, 2, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, status, sizeof(status), PHONE);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT8(2, lastReply().seq);
+    TEST_ASSERT_TRUE(knightRiderActive());
+
+    runFor(14 * 40);
+    TEST_ASSERT_FALSE(knightRiderActive());
+    TEST_ASSERT_FALSE(scheduler.isScheduled(TIMER_DISPLAY)); // Nothing left to step or expire
+}
+
+static void test_audit_log_downloads_in_mtu_sized_chunks() {
+    fake::setPeerMtu(0, 247); // 15 records per notification
+    connectAuthenticated(PHONE, 0);
+    for (uint8_t i = 0; i < 40; i++) auditLog.append(AuditEvent::Trigger, PHONE, fake::nowMicros() / 1000);
+    fake::clearNotifications();
+
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_AUDIT_READ, 9, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(200);
+
+    // Boot, the door position at power up and the connection itself come first
+    const Reply reply = replyAt(0);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_OK, reply.status);
+    TEST_ASSERT_EQUAL_UINT8(43, reply.data[0]);
+
+    std::vector<AuditRecord> records;
+    std::vector<size_t> chunkSizes;
+    for (const fake::Notification &notification : fake::notifications()) {
+        if (notification.uuid != AUDIT_CHARACTERISTIC_UUID) continue;
+        TEST_ASSERT_EQUAL_UINT16(0, notification.connId);
+        const size_t count = notification.value.size() / sizeof(AuditRecord);
+        chunkSizes.push_back(count);
+        for (size_t i = 0; i < count; i++) {
+            AuditRecord record;
+            memcpy(&record, notification.value.data() + i * sizeof(AuditRecord), sizeof(record));
+            records.push_back(record);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, chunkSizes.size());
+    TEST_ASSERT_EQUAL_UINT32(15, chunkSizes[0]);
+    TEST_ASSERT_EQUAL_UINT32(13, chunkSizes[2]);
+    for (size_t i = 0; i < records.size(); i++) {
+        TEST_ASSERT_TRUE(AuditLog::isValid(records[i]));
+        TEST_ASSERT_EQUAL_UINT32(i, records[i].sequence);
+    }
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(AuditEvent::Boot), records[0].event);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(AuditEvent::DoorClosed), records[1].event);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(AuditEvent::Connect), records[2].event);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(PHONE, records[2].address, ESP_BD_ADDR_LEN);
+}
+
+static void test_revoked_device_is_dropped_without_restart() {
+    connectAuthenticated(PHONE, 0);
+    connectAuthenticated(SECOND_PHONE, 1);
+    fake::clearNotifications();
+
+    uint8_t frame[FRAME_HEADER_SIZE + ESP_BD_ADDR_LEN] = {PROTOCOL_VERSION, OP_DEVICE_REVOKE, 4, 0, ESP_BD_ADDR_LEN};
+    memcpy(frame + FRAME_HEADER_SIZE, PHONE, ESP_BD_ADDR_LEN);
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), SECOND_PHONE, 1);
+    runFor(10);
+
+    TEST_ASSERT_EQUAL_UINT8(STATUS_OK, lastReply().status);
+    TEST_ASSERT_EQUAL_UINT8(1, lastReply().data[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::disconnectRequests().size());
+    TEST_ASSERT_EQUAL_UINT16(0, fake::disconnectRequests()[0]);
+    TEST_ASSERT_FALSE(fake::bonded(PHONE));
+    TEST_ASSERT_FALSE(bondAllowlist.contains(PHONE));
+    TEST_ASSERT_NULL(deviceRegistry.find(PHONE));
+    TEST_ASSERT_EQUAL_UINT32(0, fake::restartCount());
+
+    // The other phone stays connected and advertising keeps filtering, now without the revoked address
+    fake::disconnect(PHONE, 0);
+    runFor(READVERTISE_DELAY_MILLIS + 10);
+    TEST_ASSERT_TRUE(connections.isAuthenticated(1));
+    TEST_ASSERT_TRUE(fake::advertising()->active);
+    TEST_ASSERT_TRUE(fake::advertising()->connectFilter);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::whitelist().size());
+    TEST_ASSERT_FALSE(fake::connect(PHONE, 0));
+
+    // A second revoke of the same address is refused
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), SECOND_PHONE, 1);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_INVALID_PARAM, lastReply().status);
+}
+
+static void test_device_registry_tracks_names_and_triggers() {
+    connectAuthenticated(PHONE, 0);
+    const uint8_t frames[] = {PROTOCOL_VERSION, OP_DEVICE_NAME, 1, 0, 3, 'c', 'a', 'r',
+                              PROTOCOL_VERSION, OP_TRIGGER, 2, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frames, sizeof(frames), PHONE);
+    runFor(10);
+
+    const DeviceRecord *record = deviceRegistry.find(PHONE);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_MEMORY("car", record->name, 3);
+    TEST_ASSERT_EQUAL_UINT32(1, record->triggerCount);
+    TEST_ASSERT_TRUE(record->lastSeen > 0);
+
+    // Published once the burst is over, written to NVS once the save timer runs
+    runFor(REGISTRY_PUBLISH_MILLIS);
+    const std::string value = fake::read(DEVICES_CHARACTERISTIC_UUID);
+    TEST_ASSERT_EQUAL_UINT32(2 * sizeof(DeviceRecord), value.size());
+    TEST_ASSERT_EQUAL_UINT32(ESP_GATT_PERM_READ_ENC_MITM,
+                             fake::characteristic(DEVICES_CHARACTERISTIC_UUID)->getAccessPermissions());
+    const uint32_t writesBefore = deviceRegistry.writeCount();
+    runFor(REGISTRY_SAVE_MILLIS);
+    TEST_ASSERT_EQUAL_UINT32(writesBefore + 1, deviceRegistry.writeCount());
+    TEST_ASSERT_FALSE(deviceRegistry.isDirty());
+}
+
+static void test_full_bond_table_evicts_least_recently_seen_when_pairing_starts() {
+    fake::reset();
+    resetFirmwareState();
+    fake::addBond(PHONE);
+    fake::addBond(SECOND_PHONE);
+    uint8_t others[MAX_BONDED_DEVICES - 2][ESP_BD_ADDR_LEN];
+    for (uint8_t i = 0; i < MAX_BONDED_DEVICES - 2; i++) {
+        memcpy(others[i], STRANGER, ESP_BD_ADDR_LEN);
+        others[i][5] = 0x80 + i;
+        fake::addBond(others[i]);
+    }
+    setup();
+    runFor(10);
+    // Everyone but others[4] has been seen since, PHONE is still connected
+    for (uint8_t i = 0; i < MAX_BONDED_DEVICES - 2; i++) {
+        if (i == 4) continue;
+        deviceRegistry.touch(others[i]);
+    }
+    deviceRegistry.touch(SECOND_PHONE);
+    connectAuthenticated(PHONE, 0);
+
+    fake::setPin(BUTTON_PIN, HIGH);
+    runFor(PAIRING_PRESS_DURATION_MILLIS + 100);
+    fake::setPin(BUTTON_PIN, LOW);
+    runFor(100);
+
+    // Opening the window alone costs nobody their bond
+    TEST_ASSERT_TRUE(pairingModeActive);
+    TEST_ASSERT_TRUE(fake::bonded(others[4]));
+    TEST_ASSERT_EQUAL_UINT8(MAX_BONDED_DEVICES, bondAllowlist.size());
+
+    TEST_ASSERT_TRUE(fake::connect(STRANGER, 1));
+    fake::passKeyNotify(123456);
+    runFor(10);
+    TEST_ASSERT_FALSE(fake::bonded(others[4]));
+    TEST_ASSERT_EQUAL_UINT8(MAX_BONDED_DEVICES - 1, bondAllowlist.size());
+    TEST_ASSERT_TRUE(connections.isAuthenticated(0));
+
+    fake::authenticationComplete(STRANGER, true);
+    runFor(10);
+    TEST_ASSERT_EQUAL_UINT8(MAX_BONDED_DEVICES, bondAllowlist.size());
+    TEST_ASSERT_NOT_NULL(deviceRegistry.find(STRANGER));
+}
+
+static void test_full_allowlist_is_reloaded_by_the_loop_task() {
+    fake::reset();
+    resetFirmwareState();
+    fake::addBond(PHONE);
+    fake::addBond(SECOND_PHONE);
+    uint8_t others[MAX_BONDED_DEVICES - 2][ESP_BD_ADDR_LEN];
+    for (uint8_t i = 0; i < MAX_BONDED_DEVICES - 2; i++) {
+        memcpy(others[i], STRANGER, ESP_BD_ADDR_LEN);
+        others[i][5] = 0x80 + i;
+        fake::addBond(others[i]);
+    }
+    setup();
+    runFor(10);
+
+    // The stack dropped a bond behind the allowlist's back and took a new one
+    esp_ble_remove_bond_device(others[0]);
+    fake::authenticationComplete(STRANGER, true);
+    TEST_ASSERT_FALSE(bondAllowlist.contains(STRANGER)); // Not listed on the BLE task
+
+    runFor(10);
+    TEST_ASSERT_TRUE(bondAllowlist.contains(STRANGER));
+    TEST_ASSERT_FALSE(bondAllowlist.contains(others[0]));
+    TEST_ASSERT_EQUAL_UINT8(MAX_BONDED_DEVICES, bondAllowlist.size());
+}
+
+static void test_door_burst_is_pushed_once_to_authenticated_links() {
+    connectAuthenticated(PHONE, 0);
+    fake::connect(SECOND_PHONE, 1); // Not encrypted yet
+    runFor(10);
+    fake::clearNotifications();
+    const uint32_t coalescedBefore = telemetry.get(COUNTER_DOOR_COALESCED);
+    const uint8_t transitionsBefore = doorSensor.transitions();
+
+    // The door leaves the closed limit, drops back on it and leaves again inside one window
+    moveDoor(HIGH);
+    moveDoor(LOW);
+    moveDoor(HIGH);
+    runFor(DOOR_NOTIFY_COALESCE_MILLIS);
+
+    TEST_ASSERT_EQUAL_UINT32(1, fake::notifications().size());
+    TEST_ASSERT_EQUAL_UINT16(0, fake::notifications()[0].connId);
+    const Reply reply = lastReply();
+    TEST_ASSERT_EQUAL_UINT8(0, reply.seq);
+    TEST_ASSERT_EQUAL_UINT8(OP_DOOR_STATUS, reply.opcode);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DoorState::Moving), reply.data[0]);
+    TEST_ASSERT_EQUAL_UINT8(transitionsBefore + 3, reply.data[1]);
+    TEST_ASSERT_EQUAL_UINT32(coalescedBefore + 2, telemetry.get(COUNTER_DOOR_COALESCED));
+
+    // A burst that ends where it started sends nothing
+    moveDoor(LOW);
+    moveDoor(HIGH);
+    runFor(DOOR_NOTIFY_COALESCE_MILLIS);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::notifications().size());
+}
+
+static void test_door_state_skips_links_without_notifications_enabled() {
+    connectAuthenticated(PHONE, 0);
+    fake::connect(SECOND_PHONE, 1); // Authenticated, but its CCCD was never written
+    fake::authenticationComplete(SECOND_PHONE, true);
+    runFor(10);
+    fake::clearNotifications();
+
+    moveDoor(HIGH);
+    runFor(DOOR_NOTIFY_COALESCE_MILLIS + 10);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::notifications().size());
+    TEST_ASSERT_EQUAL_UINT16(0, fake::notifications()[0].connId);
+
+    // Turning notifications off is per link as well
+    fake::subscribe(CHARACTERISTIC_UUID, false, 0);
+    fake::subscribe(CHARACTERISTIC_UUID, true, 1);
+    fake::clearNotifications();
+    moveDoor(LOW);
+    runFor(DOOR_NOTIFY_COALESCE_MILLIS + 10);
+    TEST_ASSERT_EQUAL_UINT32(1, fake::notifications().size());
+    TEST_ASSERT_EQUAL_UINT16(1, fake::notifications()[0].connId);
+}
+
+static void test_replies_and_progress_skip_links_without_notifications_enabled() {
+    connectAuthenticated(PHONE, 0);
+    fake::subscribe(CHARACTERISTIC_UUID, false, 0);
+    fake::clearNotifications();
+
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_TRIGGER, 5, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE, 0);
+    runFor(RELAY_PULSE_MILLIS + 100);
+    TEST_ASSERT_TRUE(fake::notifications().empty());
+
+    // The answer is still there for a client that reads instead
+    Reply reply{};
+    memcpy(&reply, fake::characteristic(CHARACTERISTIC_UUID)->getValue().data(), sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT8(5, reply.seq);
+}
+
+static void test_door_status_is_read_and_requested_from_the_cache() {
+    Reply reply{};
+    const std::string value = fake::read(CHARACTERISTIC_UUID);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(Reply), value.size());
+    memcpy(&reply, value.data(), sizeof(reply));
+    TEST_ASSERT_EQUAL_UINT8(OP_DOOR_STATUS, reply.opcode);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DoorState::Closed), reply.data[0]);
+
+    connectAuthenticated(PHONE);
+    const uint8_t frame[] = {PROTOCOL_VERSION, OP_DOOR_STATUS, 9, 0, 0};
+    fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), PHONE);
+    runFor(10);
+    reply = lastReply();
+    TEST_ASSERT_EQUAL_UINT8(9, reply.seq);
+    TEST_ASSERT_EQUAL_UINT8(STATUS_OK, reply.status);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(DoorState::Closed), reply.data[0]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bonded_device_connects_and_is_encrypted);
+    RUN_TEST(test_controller_filters_unknown_devices_outside_pairing);
+    RUN_TEST(test_unknown_device_is_disconnected_when_whitelist_is_too_small);
+    RUN_TEST(test_text_trigger_pulses_relay);
+    RUN_TEST(test_binary_trigger_reports_progress);
+    RUN_TEST(test_status_reply_reports_bonds_and_pulse_length);
+    RUN_TEST(test_pairing_hold_opens_window_and_bonds_new_device);
+    RUN_TEST(test_only_a_new_bond_is_audited_as_paired);
+    RUN_TEST(test_pairing_window_times_out);
+    RUN_TEST(test_security_request_rejected_outside_pairing);
+    RUN_TEST(test_unauthenticated_connection_cannot_trigger);
+    RUN_TEST(test_advertising_continues_below_connection_limit);
+    RUN_TEST(test_replies_go_only_to_the_requesting_connection);
+    RUN_TEST(test_triggers_inside_pulse_window_coalesce);
+    RUN_TEST(test_batched_commands_take_turns_with_other_connections);
+    RUN_TEST(test_full_writes_from_every_link_fit_the_event_ring);
+    RUN_TEST(test_rejected_pairing_drops_the_pairing_link_only);
+    RUN_TEST(test_stats_characteristic_exports_telemetry);
+    RUN_TEST(test_connection_profile_follows_activity);
+    RUN_TEST(test_conn_profile_command_tunes_the_sender);
+    RUN_TEST(test_boot_advertises_before_deferred_work);
+    RUN_TEST(test_numbers_are_formatted_without_string);
+    RUN_TEST(test_idle_heartbeat_runs_while_nobody_is_connected);
+    RUN_TEST(test_heap_block_count_holds_after_boot);
+    RUN_TEST(test_relay_sweep_is_stepped_by_the_scheduler);
+    RUN_TEST(test_audit_log_downloads_in_mtu_sized_chunks);
+    RUN_TEST(test_revoked_device_is_dropped_without_restart);
+    RUN_TEST(test_device_registry_tracks_names_and_triggers);
+    RUN_TEST(test_full_bond_table_evicts_least_recently_seen_when_pairing_starts);
+    RUN_TEST(test_full_allowlist_is_reloaded_by_the_loop_task);
+    RUN_TEST(test_door_burst_is_pushed_once_to_authenticated_links);
+    RUN_TEST(test_door_state_skips_links_without_notifications_enabled);
+    RUN_TEST(test_replies_and_progress_skip_links_without_notifications_enabled);
+    RUN_TEST(test_door_status_is_read_and_requested_from_the_cache);
+    return UNITY_END();
+}
@@ -0,0 +1,421 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "AppState.h"
+#include "CommandProtocol.h"
+#include "EventHandlers.h"
+
+// Abuse scenarios replayed against setup()/loop() and the real BLE callbacks: a timed script
+// is expanded into events, each fired through the fake stack at its virtual time, with loop()
+// running in between exactly as it would on the device. The checks are on what the firmware
+// did (relay pulses, answers, rejections); the timings are host figures for comparing commits
+// on the same machine. Run with `pio test -e native -f test_load -v` to see the report.
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const uint8_t PHONE[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+const uint8_t SECOND_PHONE[ESP_BD_ADDR_LEN] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x61};
+
+enum class Action : uint8_t {
+    Connect,
+    Authenticate,    // The link finishes MITM encryption with its stored keys
+    SecurityRequest, // The peer asks to pair
+    TextTrigger,     // Legacy "TRIGGER" write
+    BinaryTrigger,   // One OP_TRIGGER frame
+    Disconnect,      // Also the stack completing a disconnect the firmware asked for
+    Count
+};
+
+const char *const ACTION_NAMES[] = {"connect", "authenticate", "security req", "text trigger", "binary trigger",
+                                    "disconnect"};
+static_assert(sizeof(ACTION_NAMES) / sizeof(ACTION_NAMES[0]) == static_cast<size_t>(Action::Count),
+              "One name per action");
+
+enum class Peer : uint8_t {
+    Phone,       // Bonded, connId 0
+    SecondPhone, // Bonded, connId 1
+    Stranger,    // Unknown, a fresh address and connId for every event
+};
+
+// One line of a script: `count` events `everyMillis` apart, the first at `atMillis`
+struct Step {
+    uint32_t atMillis;
+    Action action;
+    Peer peer;
+    uint16_t count;
+    uint32_t everyMillis;
+};
+
+struct ScriptEvent {
+    uint64_t atMicros;
+    Action action;
+    Peer peer;
+    uint16_t serial; // Position among the step's events
+};
+
+struct ActionStats {
+    uint32_t events = 0;
+    Clock::duration total{};
+    Clock::duration worst{};
+};
+
+struct LoadReport {
+    ActionStats actions[static_cast<size_t>(Action::Count)];
+    uint32_t events = 0;
+    uint32_t filtered = 0;         // Connects the controller refused before onConnect
+    Clock::duration loopTime{};    // Every loop() pass, script and run-out
+    size_t maxEventDepth = 0;      // bleEvents right after a batch of callbacks
+    size_t maxCommandDepth = 0;    // commandQueue after a loop() pass
+    uint32_t eventsDropped = 0;
+    uint32_t triggers = 0;         // Text and binary trigger writes sent
+    uint32_t triggerAnswers = 0;   // Accepted, coalesced and busy answers to them
+    uint32_t busyAnswers = 0;
+    uint32_t relayPulses = 0;
+    uint64_t relayHighMicros = 0;
+    uint32_t displayUpdates = 0;
+    uint32_t spiTransactions = 0;
+    uint32_t rejectedConnections = 0;
+    uint32_t rejectedSecurity = 0;
+    uint32_t coalescedTriggers = 0;
+    uint32_t commandsDropped = 0;
+};
+
+struct Link {
+    uint8_t address[ESP_BD_ADDR_LEN];
+};
+
+// Firmware globals outlive fake::reset(), put the ones a scenario can leave behind back to idle
+void resetFirmwareState() {
+    for (uint8_t slot = 0; slot < Scheduler::MAX_TIMERS; slot++) scheduler.cancel(slot);
+    BleEvent event;
+    while (bleEvents.pop(event)) {}
+    while (commandQueue.pop(event)) {}
+    connections.clear();
+    pairingModeActive = false;
+    allowNewPairing = false;
+    currentDisplayedPasskey = 0;
+}
+
+class ScenarioRunner {
+public:
+    LoadReport run(const Step *steps, const size_t stepCount, const uint32_t runOutMillis) {
+        startCounters();
+        const std::vector<ScriptEvent> events = expand(steps, stepCount);
+        for (size_t i = 0; i < events.size();) {
+            runUntil(events[i].atMicros);
+            // Everything due at the same instant reaches the callbacks before loop() runs again
+            const uint64_t now = events[i].atMicros;
+            for (; i < events.size() && events[i].atMicros == now; i++) fire(events[i]);
+            report.maxEventDepth = std::max(report.maxEventDepth, bleEvents.size());
+        }
+        runUntil(fake::nowMicros() + static_cast<uint64_t>(runOutMillis) * 1000);
+        finishCounters();
+        return report;
+    }
+
+private:
+    static std::vector<ScriptEvent> expand(const Step *steps, const size_t stepCount) {
+        std::vector<ScriptEvent> events;
+        for (size_t s = 0; s < stepCount; s++) {
+            const Step &step = steps[s];
+            for (uint16_t n = 0; n < step.count; n++) {
+                const uint64_t at = (static_cast<uint64_t>(step.atMillis) + static_cast<uint64_t>(n) * step.everyMillis) * 1000;
+                events.push_back({at, step.action, step.peer, n});
+            }
+        }
+        // Script order breaks ties, so a burst fires exactly as written
+        std::stable_sort(events.begin(), events.end(),
+                         [](const ScriptEvent &a, const ScriptEvent &b) { return a.atMicros < b.atMicros; });
+        return events;
+    }
+
+    // Runs loop() until the virtual clock reaches `micros`. A one shot timer plays the radio
+    // interrupt that wakes the loop task, so its sleep never runs past the next script event.
+    void runUntil(const uint64_t micros) {
+        if (micros <= fake::nowMicros()) return;
+        esp_timer_handle_t wake = nullptr;
+        const esp_timer_create_args_t args = {[](void *) { xTaskNotifyGive(loopTaskHandle); }, nullptr,
+                                              ESP_TIMER_TASK, "script", false};
+        esp_timer_create(&args, &wake);
+        esp_timer_start_once(wake, micros - fake::nowMicros());
+
+        while (fake::nowMicros() < micros) {
+            const uint64_t before = fake::nowMicros();
+            const Clock::time_point start = Clock::now();
+            loop();
+            report.loopTime += Clock::now() - start;
+            report.maxCommandDepth = std::max(report.maxCommandDepth, commandQueue.size());
+            // loop() returns without sleeping when nothing is scheduled; step the clock ourselves
+            if (fake::nowMicros() == before) fake::advanceMicros(std::min<uint64_t>(1000, micros - before));
+            fake::clearSerialOutput();
+        }
+        esp_timer_stop(wake);
+        esp_timer_delete(wake);
+    }
+
+    void fire(const ScriptEvent &event) {
+        uint8_t address[ESP_BD_ADDR_LEN];
+        const uint16_t connId = peer(event, address);
+
+        const Clock::time_point start = Clock::now();
+        switch (event.action) {
+            case Action::Connect:
+                if (fake::connect(address, connId)) {
+                    memcpy(links[connId].address, address, ESP_BD_ADDR_LEN);
+                    fake::subscribe(CHARACTERISTIC_UUID, true, connId); // The app enables replies right away
+                } else {
+                    report.filtered++;
+                }
+                break;
+            case Action::Authenticate:
+                fake::authenticationComplete(address, true);
+                break;
+            case Action::SecurityRequest:
+                fake::securityRequest();
+                break;
+            case Action::TextTrigger:
+                fake::write(CHARACTERISTIC_UUID, "TRIGGER", address, connId);
+                report.triggers++;
+                break;
+            case Action::BinaryTrigger: {
+                const uint8_t frame[] = {PROTOCOL_VERSION, OP_TRIGGER, static_cast<uint8_t>(event.serial), 0, 0};
+                fake::write(CHARACTERISTIC_UUID, frame, sizeof(frame), address, connId);
+                report.triggers++;
+                break;
+            }
+            case Action::Disconnect:
+                fake::disconnect(address, connId);
+                links.erase(connId);
+                break;
+            case Action::Count:
+                break;
+        }
+        record(event.action, Clock::now() - start);
+        completeDisconnects();
+    }
+
+    // The stack drops the links the firmware asked it to, each reported through onDisconnect
+    void completeDisconnects() {
+        const std::vector<uint16_t> &requests = fake::disconnectRequests();
+        for (; servedDisconnects < requests.size(); servedDisconnects++) {
+            const auto link = links.find(requests[servedDisconnects]);
+            if (link == links.end()) continue; // Already gone
+            const Clock::time_point start = Clock::now();
+            fake::disconnect(link->second.address, link->first);
+            record(Action::Disconnect, Clock::now() - start);
+            links.erase(link);
+        }
+    }
+
+    uint16_t peer(const ScriptEvent &event, uint8_t address[ESP_BD_ADDR_LEN]) {
+        switch (event.peer) {
+            case Peer::Phone:
+                memcpy(address, PHONE, ESP_BD_ADDR_LEN);
+                return 0;
+            case Peer::SecondPhone:
+                memcpy(address, SECOND_PHONE, ESP_BD_ADDR_LEN);
+                return 1;
+            case Peer::Stranger:
+                break;
+        }
+        const uint32_t stranger = strangers++;
+        const uint8_t unknown[ESP_BD_ADDR_LEN] = {0xDE, 0xAD, 0xBE, static_cast<uint8_t>(stranger >> 16),
+                                                  static_cast<uint8_t>(stranger >> 8), static_cast<uint8_t>(stranger)};
+        memcpy(address, unknown, ESP_BD_ADDR_LEN);
+        return 2 + stranger % 200;
+    }
+
+    void record(const Action action, const Clock::duration elapsed) {
+        ActionStats &stats = report.actions[static_cast<size_t>(action)];
+        stats.events++;
+        stats.total += elapsed;
+        stats.worst = std::max(stats.worst, elapsed);
+        report.events++;
+    }
+
+    void startCounters() {
+        dropsBefore = bleEvents.droppedCount();
+        displayBefore = telemetry.get(COUNTER_DISPLAY_UPDATES);
+        spiBefore = fake::spiTransactions();
+        pulsesBefore = fake::pinRisingWrites(RELAY_PIN);
+        highBefore = fake::pinHighMicros(RELAY_PIN);
+        rejectedConnectionsBefore = telemetry.get(COUNTER_REJECTED_CONNECTIONS);
+        rejectedSecurityBefore = telemetry.get(COUNTER_REJECTED_SECURITY);
+        coalescedBefore = telemetry.get(COUNTER_COALESCED_TRIGGERS);
+        commandsDroppedBefore = telemetry.get(COUNTER_COMMANDS_DROPPED);
+        notificationsBefore = fake::notifications().size();
+    }
+
+    void finishCounters() {
+        report.eventsDropped = bleEvents.droppedCount() - dropsBefore;
+        report.displayUpdates = telemetry.get(COUNTER_DISPLAY_UPDATES) - displayBefore;
+        report.spiTransactions = fake::spiTransactions() - spiBefore;
+        report.relayPulses = fake::pinRisingWrites(RELAY_PIN) - pulsesBefore;
+        report.relayHighMicros = fake::pinHighMicros(RELAY_PIN) - highBefore;
+        report.rejectedConnections = telemetry.get(COUNTER_REJECTED_CONNECTIONS) - rejectedConnectionsBefore;
+        report.rejectedSecurity = telemetry.get(COUNTER_REJECTED_SECURITY) - rejectedSecurityBefore;
+        report.coalescedTriggers = telemetry.get(COUNTER_COALESCED_TRIGGERS) - coalescedBefore;
+        report.commandsDropped = telemetry.get(COUNTER_COMMANDS_DROPPED) - commandsDroppedBefore;
+
+        // Answers to trigger writes, leaving out the energized/released progress that follows
+        const std::vector<fake::Notification> &notifications = fake::notifications();
+        for (size_t i = notificationsBefore; i < notifications.size(); i++) {
+            const std::string &value = notifications[i].value;
+            if (value == "Command accepted") report.triggerAnswers++;
+            if (value == "Relay busy") {
+                report.triggerAnswers++;
+                report.busyAnswers++;
+            }
+            if (value.size() != sizeof(Reply)) continue;
+            Reply reply{};
+            memcpy(&reply, value.data(), sizeof(Reply));
+            if (reply.opcode != OP_TRIGGER) continue;
+            if (reply.status == STATUS_ACCEPTED || reply.status == STATUS_COALESCED) report.triggerAnswers++;
+            if (reply.status == STATUS_BUSY) {
+                report.triggerAnswers++;
+                report.busyAnswers++;
+            }
+        }
+    }
+
+    LoadReport report;
+    std::map<uint16_t, Link> links; // Open as far as the stack knows
+    size_t servedDisconnects = fake::disconnectRequests().size();
+    uint32_t strangers = 0;
+    uint32_t dropsBefore = 0, displayBefore = 0, spiBefore = 0, pulsesBefore = 0;
+    uint64_t highBefore = 0;
+    uint32_t rejectedConnectionsBefore = 0, rejectedSecurityBefore = 0, coalescedBefore = 0, commandsDroppedBefore = 0;
+    size_t notificationsBefore = 0;
+};
+
+double nanos(const Clock::duration duration) {
+    return std::chrono::duration<double, std::nano>(duration).count();
+}
+
+void printReport(const char *scenario, const LoadReport &report) {
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %u events, loop %.0f ns/event, queue depth %u events / %u commands, %u dropped",
+             scenario, report.events, report.events ? nanos(report.loopTime) / report.events : 0.0,
+             static_cast<unsigned>(report.maxEventDepth), static_cast<unsigned>(report.maxCommandDepth),
+             report.eventsDropped);
+    TEST_MESSAGE(line);
+    for (size_t i = 0; i < static_cast<size_t>(Action::Count); i++) {
+        const ActionStats &stats = report.actions[i];
+        if (stats.events == 0) continue;
+        snprintf(line, sizeof(line), "  %-14s %6u x %8.0f ns/event, worst %8.0f ns", ACTION_NAMES[i], stats.events,
+                 nanos(stats.total) / stats.events, nanos(stats.worst));
+        TEST_MESSAGE(line);
+    }
+    snprintf(line, sizeof(line),
+             "  relay %u pulses (%u triggers, %u coalesced, %u busy), display %u updates / %u SPI transactions",
+             report.relayPulses, report.triggers, report.coalescedTriggers, report.busyAnswers, report.displayUpdates,
+             report.spiTransactions);
+    TEST_MESSAGE(line);
+}
+
+// Every trigger was answered, started exactly one full pulse or joined the one running
+void assertRelayAccounting(const LoadReport &report) {
+    TEST_ASSERT_EQUAL_UINT32(report.triggers, report.triggerAnswers + report.commandsDropped);
+    const uint32_t accepted = report.triggers - report.coalescedTriggers - report.busyAnswers;
+    TEST_ASSERT_EQUAL_UINT32(accepted, report.relayPulses);
+    TEST_ASSERT_EQUAL_UINT64(static_cast<uint64_t>(report.relayPulses) * RELAY_PULSE_MILLIS * 1000,
+                             report.relayHighMicros);
+    TEST_ASSERT_FALSE(fake::pinLevel(RELAY_PIN));
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+    resetFirmwareState();
+    fake::addBond(PHONE);
+    fake::addBond(SECOND_PHONE);
+}
+
+void tearDown() {}
+
+static void load_connection_storm() {
+    // More bonds than whitelist entries keeps advertising open, so every stranger reaches onConnect
+    fake::setWhitelistCapacity(1);
+    setup();
+    TEST_ASSERT_FALSE(fake::advertising()->connectFilter);
+
+    // 300 unknown devices a minute, a burst of 12 in one instant, then the owner gets in
+    const Step script[] = {
+        {0, Action::Connect, Peer::Stranger, 300, 200},
+        {30100, Action::Connect, Peer::Stranger, 12, 0},
+        {61000, Action::Connect, Peer::Phone, 1, 0},
+        {61010, Action::Authenticate, Peer::Phone, 1, 0},
+        {61100, Action::BinaryTrigger, Peer::Phone, 1, 0},
+        {63000, Action::Disconnect, Peer::Phone, 1, 0},
+    };
+    const LoadReport report = ScenarioRunner().run(script, sizeof(script) / sizeof(script[0]), 6000);
+    printReport("connection storm", report);
+
+    TEST_ASSERT_EQUAL_UINT32(0, report.filtered);
+    TEST_ASSERT_EQUAL_UINT32(312, report.rejectedConnections);
+    TEST_ASSERT_EQUAL_UINT32(0, report.eventsDropped);
+    TEST_ASSERT_EQUAL_UINT8(0, connections.count());
+    TEST_ASSERT_EQUAL_UINT32(1, report.relayPulses);
+    assertRelayAccounting(report);
+}
+
+static void load_security_requests_outside_pairing() {
+    setup();
+
+    // A device showing a bonded address without its keys, asking to pair again and again
+    const Step script[] = {
+        {0, Action::Connect, Peer::Phone, 200, 300},
+        {5, Action::SecurityRequest, Peer::Phone, 200, 300},
+    };
+    const LoadReport report = ScenarioRunner().run(script, sizeof(script) / sizeof(script[0]), 6000);
+    printReport("security requests", report);
+
+    TEST_ASSERT_EQUAL_UINT32(200, report.rejectedSecurity);
+    TEST_ASSERT_EQUAL_UINT32(200, report.actions[static_cast<size_t>(Action::Disconnect)].events);
+    TEST_ASSERT_EQUAL_UINT32(0, report.eventsDropped);
+    TEST_ASSERT_FALSE(allowNewPairing);
+    TEST_ASSERT_EQUAL_UINT32(0, currentDisplayedPasskey);
+    TEST_ASSERT_EQUAL_UINT8(0, connections.count());
+    TEST_ASSERT_EQUAL_UINT32(0, report.relayPulses);
+}
+
+static void load_trigger_flood() {
+    setup();
+
+    // One phone pipelining binary triggers every 20 ms, the other typing TRIGGER every 45 ms
+    const Step script[] = {
+        {0, Action::Connect, Peer::Phone, 1, 0},
+        {10, Action::Authenticate, Peer::Phone, 1, 0},
+        {20, Action::Connect, Peer::SecondPhone, 1, 0},
+        {30, Action::Authenticate, Peer::SecondPhone, 1, 0},
+        {100, Action::BinaryTrigger, Peer::Phone, 500, 20},
+        {110, Action::TextTrigger, Peer::SecondPhone, 220, 45},
+        {10200, Action::Disconnect, Peer::Phone, 1, 0},
+        {10210, Action::Disconnect, Peer::SecondPhone, 1, 0},
+    };
+    const LoadReport report = ScenarioRunner().run(script, sizeof(script) / sizeof(script[0]), 6000);
+    printReport("trigger flood", report);
+
+    TEST_ASSERT_EQUAL_UINT32(720, report.triggers);
+    TEST_ASSERT_EQUAL_UINT32(0, report.eventsDropped);
+    TEST_ASSERT_EQUAL_UINT32(0, report.commandsDropped);
+    assertRelayAccounting(report);
+    // One pulse at a time: never more than the flood's span fits back to back
+    TEST_ASSERT_TRUE(report.relayPulses >= 10000 / (2 * RELAY_PULSE_MILLIS));
+    TEST_ASSERT_TRUE(report.relayPulses <= 10000 / RELAY_PULSE_MILLIS + 1);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(load_connection_storm);
+    RUN_TEST(load_security_requests_outside_pairing);
+    RUN_TEST(load_trigger_flood);
+    return UNITY_END();
+}
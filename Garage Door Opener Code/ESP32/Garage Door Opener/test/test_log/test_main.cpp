@@ -0,0 +1,105 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include <thread>
+
+#include "Log.h"
+
+namespace {
+const uint8_t PHONE[6] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+
+bool printed(const char *text) {
+    return fake::serialOutput().find(text) != std::string::npos;
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+    logger.drain(Serial);
+    fake::reset();
+}
+
+void tearDown() {}
+
+static void test_records_are_formatted_only_when_drained() {
+    fake::advanceMillis(1234);
+    LOG_WARN(LOG_UNKNOWN_OPCODE, 0x7f, 9);
+    LOG_INFO_ADDR(LOG_CONNECTED, PHONE, 0);
+    TEST_ASSERT_TRUE(fake::serialOutput().empty());
+
+    TEST_ASSERT_EQUAL_UINT32(2, logger.drain(Serial));
+    TEST_ASSERT_TRUE(printed("1.234 W Unknown opcode 0x7f (seq 9)\r\n"));
+    TEST_ASSERT_TRUE(printed("1.234 I Connected 10:20:30:40:50:60 (status 0)"));
+    TEST_ASSERT_EQUAL_UINT32(0, logger.drain(Serial));
+}
+
+static void test_flush_holds_the_output_for_a_direct_dump() {
+    LOG_INFO(LOG_TRIGGER_ACCEPTED, 1);
+    logger.flush(Serial, [](Print &out) {
+        out.print("dump start ");
+        LOG_INFO(LOG_TRIGGER_ACCEPTED, 2);
+        TEST_ASSERT_EQUAL_UINT32(0, logger.drain(out)); // The log task would have to wait
+        out.print("dump end");
+    });
+    TEST_ASSERT_TRUE(printed("(seq 1) ---\r\ndump start dump end"));
+    TEST_ASSERT_FALSE(printed("(seq 2)"));
+
+    TEST_ASSERT_EQUAL_UINT32(1, logger.drain(Serial));
+    TEST_ASSERT_TRUE(printed("dump end0.000 I"));
+}
+
+static void test_levels_above_log_level_compile_out() {
+    const uint32_t written = logger.writtenCount();
+    int evaluated = 0;
+    LOG_DEBUG(LOG_HOLD_COUNTDOWN, ++evaluated); // Default build logs up to LOG_LEVEL_INFO
+    TEST_ASSERT_EQUAL_INT(0, evaluated);
+    TEST_ASSERT_EQUAL_UINT32(written, logger.writtenCount());
+}
+
+static void test_full_ring_drops_and_reports_the_loss() {
+    const uint32_t dropped = logger.droppedCount();
+    for (size_t i = 0; i < LOG_QUEUE_SIZE + 3; i++) LOG_INFO(LOG_TRIGGER_ACCEPTED, i);
+    TEST_ASSERT_EQUAL_UINT32(dropped + 3, logger.droppedCount());
+
+    TEST_ASSERT_EQUAL_UINT32(LOG_QUEUE_SIZE, logger.drain(Serial));
+    TEST_ASSERT_TRUE(printed("(seq 0)"));
+    TEST_ASSERT_TRUE(printed("(seq 63)"));
+    TEST_ASSERT_FALSE(printed("(seq 64)"));
+    TEST_ASSERT_TRUE(printed("Log: 3 message(s) dropped"));
+}
+
+static void test_concurrent_producers_lose_nothing() {
+    MpscRing<uint32_t, 256> ring;
+    constexpr uint32_t PER_PRODUCER = 100000;
+    uint32_t next[2] = {0, 0};
+    uint32_t received = 0;
+    std::thread producers[2];
+    for (uint32_t p = 0; p < 2; p++) {
+        producers[p] = std::thread([&ring, p]() {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                while (!ring.push(p << 24 | i)) std::this_thread::yield();
+            }
+        });
+    }
+    // Each producer's items arrive complete and in its own order
+    while (received < 2 * PER_PRODUCER) {
+        uint32_t item;
+        if (!ring.pop(item)) continue;
+        const uint32_t producer = item >> 24;
+        TEST_ASSERT_EQUAL_UINT32(next[producer]++, item & 0xFFFFFF);
+        received++;
+    }
+    for (std::thread &producer : producers) producer.join();
+    TEST_ASSERT_EQUAL_UINT32(2 * PER_PRODUCER, ring.pushedCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_are_formatted_only_when_drained);
+    RUN_TEST(test_flush_holds_the_output_for_a_direct_dump);
+    RUN_TEST(test_levels_above_log_level_compile_out);
+    RUN_TEST(test_full_ring_drops_and_reports_the_loss);
+    RUN_TEST(test_concurrent_producers_lose_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,85 @@
+#include <unity.h>
+
+#include <FakeHarness.h>
+
+#include "Scheduler.h"
+
+namespace {
+int firstRuns = 0;
+int secondRuns = 0;
+Scheduler *active = nullptr;
+
+void first() { firstRuns++; }
+void second() { secondRuns++; }
+void rearmFirst() {
+    secondRuns++;
+    active->schedule(0, 10);
+}
+} // namespace
+
+void setUp() {
+    fake::reset();
+    firstRuns = 0;
+    secondRuns = 0;
+}
+
+void tearDown() {}
+
+static void test_runs_only_due_slots() {
+    Scheduler scheduler;
+    scheduler.setHandler(0, first);
+    scheduler.setHandler(1, second);
+    scheduler.schedule(0, 100);
+    scheduler.schedule(1, 300);
+
+    TEST_ASSERT_EQUAL_UINT32(100, scheduler.millisUntilNext(millis()));
+    fake::advanceMillis(100);
+    scheduler.runDue(millis());
+    TEST_ASSERT_EQUAL_INT(1, firstRuns);
+    TEST_ASSERT_EQUAL_INT(0, secondRuns);
+    TEST_ASSERT_FALSE(scheduler.isScheduled(0));
+    TEST_ASSERT_EQUAL_UINT32(200, scheduler.millisUntilNext(millis()));
+}
+
+static void test_reschedule_moves_deadline_and_cancel_disarms() {
+    Scheduler scheduler;
+    scheduler.setHandler(0, first);
+    scheduler.schedule(0, 100);
+    fake::advanceMillis(50);
+    scheduler.schedule(0, 100); // Now due at 150
+
+    fake::advanceMillis(60);
+    scheduler.runDue(millis());
+    TEST_ASSERT_EQUAL_INT(0, firstRuns);
+
+    scheduler.cancel(0);
+    fake::advanceMillis(100);
+    scheduler.runDue(millis());
+    TEST_ASSERT_EQUAL_INT(0, firstRuns);
+    TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, scheduler.millisUntilNext(millis()));
+}
+
+static void test_handler_may_schedule_from_inside_run_due() {
+    Scheduler scheduler;
+    active = &scheduler;
+    scheduler.setHandler(0, first);
+    scheduler.setHandler(1, rearmFirst);
+    scheduler.schedule(1, 5);
+
+    fake::advanceMillis(5);
+    scheduler.runDue(millis());
+    TEST_ASSERT_EQUAL_INT(1, secondRuns);
+    TEST_ASSERT_TRUE(scheduler.isScheduled(0));
+
+    fake::advanceMillis(10);
+    scheduler.runDue(millis());
+    TEST_ASSERT_EQUAL_INT(1, firstRuns);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_runs_only_due_slots);
+    RUN_TEST(test_reschedule_moves_deadline_and_cancel_disarms);
+    RUN_TEST(test_handler_may_schedule_from_inside_run_due);
+    return UNITY_END();
+}